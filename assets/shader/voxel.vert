@@ -1,44 +1,15 @@
-#version 440 core
+#version 460 core
 
-layout (location = 0) in vec3 position;
-layout (location = 1) in vec3 uv;
-layout (location = 2) in vec3 normal;
-layout (location = 3) in uint voxelType;
+// packed chunk mesh vertex, see VoxelVertex.hpp
+//   bits  0-6 x, 7-13 y, 14-20 z, 21-23 normal index, 24-31 voxel type
+layout (location = 0) in uint packedVertex;
 
-uniform ivec3 chunkSize;
-uniform vec3 chunkCoord;
-
-// A single iteration of Bob Jenkins' One-At-A-Time hashing algorithm.
-uint hash( uint x ) {
-    x += ( x << 10u );
-    x ^= ( x >>  6u );
-    x += ( x <<  3u );
-    x ^= ( x >> 11u );
-    x += ( x << 15u );
-    return x;
-}
-// Compound versions of the hashing algorithm I whipped together.
-uint hash( uvec2 v ) { return hash( v.x ^ hash(v.y)                         ); }
-uint hash( uvec3 v ) { return hash( v.x ^ hash(v.y) ^ hash(v.z)             ); }
-uint hash( uvec4 v ) { return hash( v.x ^ hash(v.y) ^ hash(v.z) ^ hash(v.w) ); }
-
-// Construct a float with half-open range [0:1] using low 23 bits.
-// All zeroes yields 0.0, all ones yields the next smallest representable value below 1.0.
-float floatConstruct( uint m ) {
-    const uint ieeeMantissa = 0x007FFFFFu; // binary32 mantissa bitmask
-    const uint ieeeOne      = 0x3F800000u; // 1.0 in IEEE binary32
-
-    m &= ieeeMantissa;                     // Keep only mantissa bits (fractional part)
-    m |= ieeeOne;                          // Add fractional part to 1.0
-
-    float  f = uintBitsToFloat( m );       // Range [1:2]
-    return f - 1.0;                        // Range [0:1]
-}
-
-float rand( float x ) { return floatConstruct(hash(floatBitsToUint(x))); }
-float rand( vec2  v ) { return floatConstruct(hash(floatBitsToUint(v))); }
-float rand( vec3  v ) { return floatConstruct(hash(floatBitsToUint(v))); }
-float rand( vec4  v ) { return floatConstruct(hash(floatBitsToUint(v))); }
+// one entry per draw of ChunkArena's multi-draw: chunk origin in xyz, and in w the size of a mesh voxel in world
+// voxels (above 1 for level-of-detail meshes)
+layout (std430, binding = 0) readonly buffer ChunkDraws
+{
+	vec4 chunkDraws[];
+};
 
 layout (std140, column_major) uniform Matrices 
 {
@@ -46,19 +17,41 @@ layout (std140, column_major) uniform Matrices
 	mat4 u_projectionMatrix;
 };
 
+// indexed by NormalIndex(): left, right, down, up, forward, back
+const vec3 normals[6] = vec3[6](
+	vec3(-1.0, 0.0, 0.0),
+	vec3( 1.0, 0.0, 0.0),
+	vec3( 0.0,-1.0, 0.0),
+	vec3( 0.0, 1.0, 0.0),
+	vec3( 0.0, 0.0,-1.0),
+	vec3( 0.0, 0.0, 1.0)
+);
+
+// matches Chunk::voxelColors
+const vec3 voxelColors[5] = vec3[5](
+	vec3(1.0, 1.0, 1.0),
+	vec3(0.6, 0.6, 0.6),
+	vec3(0.588, 0.294, 0.0),
+	vec3(0.0, 1.0, 0.0),
+	vec3(0.3, 0.3, 0.3)
+);
+
+const vec3 lightDirection = normalize(vec3(0.3, 1.0, 0.5));
+
 out vec3 voxelColor;
 
 void main() {
-	//(z * CHUNK_SIZE_X * CHUNK_SIZE_Y) + (y * CHUNK_SIZE_X) + x;
-	uint idx = gl_InstanceID;
-	float z = float(idx / (chunkSize.x * chunkSize.y));
-	idx -= int(z * chunkSize.x * chunkSize.y);
-	
-	float y = float(idx / chunkSize.x);
-	float x = float(idx % chunkSize.x);
-	vec3 positionInChunk = vec3(x, y, z) + chunkCoord;
-	
-	gl_Position = u_projectionMatrix * u_viewMatrix * vec4((positionInChunk + position), 1.0);
-	voxelColor = vec3(rand(positionInChunk));
-
+	vec3 positionInChunk = vec3(
+		float(packedVertex & 0x7Fu),
+		float((packedVertex >> 7u) & 0x7Fu),
+		float((packedVertex >> 14u) & 0x7Fu));
+	uint normalIndex = (packedVertex >> 21u) & 0x7u;
+	uint voxelType = packedVertex >> 24u;
+
+	vec4 chunkDraw = chunkDraws[gl_DrawID];
+	gl_Position = u_projectionMatrix * u_viewMatrix * vec4(positionInChunk * chunkDraw.w + chunkDraw.xyz, 1.0);
+
+	// flat ambient + lambert so faces of the same colour are still distinguishable
+	float light = 0.4 + 0.6 * max(dot(normals[normalIndex], lightDirection), 0.0);
+	voxelColor = voxelColors[min(voxelType, 4u)] * light;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <string>
 #include <stbi/stb_image.h>
 
 #include <sogl/structure/linkedList.h>
@@ -10,6 +11,7 @@
 #include <sogl/rendering/glUtilities.h>
 #include <sogl/structure/runLengthEncoding.h>
 #include <sogl/rendering/renderable.hpp>
+#include <sogl/rendering/RenderQueue.h>
 #include <sogl/rendering/camera.hpp>
 #include <sogl/rendering/factories/MaterialFactory.h>
 #include <sogl/rendering/color.hpp>
@@ -21,8 +23,7 @@
 #include <sogl/rendering/factories/lightFactory.hpp>
 #include <sogl/rendering/factories/ModelFactory.h>
 
-#include <sogl/world/data/chunk.h>
-#include <sogl/world/data/chunkMesh.h>
+#include <sogl/world/ChunkManager.h>
 using namespace sogl;
 
 const int W_WIDTH = 800;
@@ -140,8 +141,11 @@ int main() {
 	camera* const renderCamera = getRenderCamera();
 	debug::setPointSize(5);
 	
-	Chunk ch(vec3f(0, 0, 0));
-	ChunkMesh chMesh(ch);
+	ChunkManagerSettings worldSettings;
+	worldSettings.saveDirectory = "saves";
+	ChunkManager world(worldSettings);
+	RenderQueue renderQueue;
+	float nextStatsTime = 0.0f;
 	while (!glfwWindowShouldClose(windPtr)) {
 		glStartFrame();
 		glPollEvents();
@@ -176,21 +180,29 @@ int main() {
 		pointLight2->positionOrDirection = vec4f(2 * -sinf(getTime()), 1, (2 * -cosf(getTime())) - 5, 0);
 		//lightFactory::updateLightBuffer(pointLight1);
 		lightFactory::updateLightBuffer(pointLight2);
-		viviRenderable.render();
-		viviWandRenderable.render();
-		planeRenderable.render();
-		//ch.draw();
+		const Frustum frustum = renderCamera->getFrustum();
+		renderQueue.Submit(viviRenderable);
+		renderQueue.Submit(viviWandRenderable);
+		renderQueue.Submit(planeRenderable);
+		renderQueue.Flush(frustum);
+		world.Update(renderCamera->position);
+		world.Draw(&frustum);
+
+		if (getTime() >= nextStatsTime) {
+			const ChunkRenderStats& stats = world.RenderStats();
+			std::string title = "Shir0 Open Game Library - " + std::to_string(stats.drawnChunks) + " chunks (" +
+				std::to_string(stats.culledChunks) + " culled), " +
+				std::to_string(stats.triangles) + " tris, " + std::to_string(stats.gpuTimeMs) + " ms GPU";
+			glfwSetWindowTitle(windPtr, title.c_str());
+			nextStatsTime = getTime() + 1.0f;
+		}
 		//tree.drawOutline();
 		
-		//glBegin(GL_TRIANGLES);
-		//for (int i = 0; i < chMesh.meshData->VertexCount(); i+= 3) {
-		//	glVertex3f(chMesh.meshData->Vertices()[i], chMesh.meshData->Vertices()[i + 1], chMesh.meshData->Vertices()[i + 2]);
-		//}
-		//glEnd();
 		debug::finalize();
 
 		glfwSwapBuffers(windPtr);
 	}
 
+	world.Clear();
 	glTerminate();
 }
\ No newline at end of file
@@ -1,32 +1,74 @@
+#pragma once
+
 #include <stdint.h>
-#include <bitset>
+
+#if defined(__has_include)
+#if __has_include(<bit>)
+#include <bit>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
 
 namespace sogl {
-	uint64_t trailing_zeroes(const uint64_t value) {
-		std::bitset<64> b;
-		b |= value;
-		uint64_t bits = 0;
-		for (uint64_t i = 0; i < 64; i++) {
-			if (b[i] == 0)
-				bits++;
-			else
-				break;
-		}
+	// Number of zero bits below the lowest set bit. Returns 64 for 0.
+	inline uint64_t trailing_zeroes(const uint64_t value) {
+#if defined(__cpp_lib_bitops)
+		return static_cast<uint64_t>(std::countr_zero(value));
+#elif defined(__GNUC__) || defined(__clang__)
+		// ctz is undefined for 0, this compiles down to a cmov
+		return value == 0 ? 64 : static_cast<uint64_t>(__builtin_ctzll(value));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+		unsigned long index;
+		return _BitScanForward64(&index, value) ? index : 64;
+#else
+		if (value == 0)
+			return 64;
 
+		// isolate the lowest set bit and binary search its position
+		uint64_t v = value & (~value + 1);
+		uint64_t bits = 63;
+		if (v & 0x00000000FFFFFFFFull) bits -= 32;
+		if (v & 0x0000FFFF0000FFFFull) bits -= 16;
+		if (v & 0x00FF00FF00FF00FFull) bits -= 8;
+		if (v & 0x0F0F0F0F0F0F0F0Full) bits -= 4;
+		if (v & 0x3333333333333333ull) bits -= 2;
+		if (v & 0x5555555555555555ull) bits -= 1;
 		return bits;
+#endif
 	}
 
-	uint64_t trailing_ones(const uint64_t value) {
-		std::bitset<64> b;
-		b |= value;
-		uint64_t bits = 0;
-		for (uint64_t i = 0; i < 64; i++) {
-			if (b[i] == 1)
-				bits++;
-			else
-				break;
-		}
+	// Number of one bits below the lowest clear bit. Returns 64 for ~0.
+	inline uint64_t trailing_ones(const uint64_t value) {
+		return trailing_zeroes(~value);
+	}
 
-		return bits;
+	// Number of set bits.
+	inline uint64_t popcount(const uint64_t value) {
+#if defined(__cpp_lib_bitops)
+		return static_cast<uint64_t>(std::popcount(value));
+#elif defined(__GNUC__) || defined(__clang__)
+		return static_cast<uint64_t>(__builtin_popcountll(value));
+#else
+		uint64_t v = value - ((value >> 1) & 0x5555555555555555ull);
+		v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+		v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return (v * 0x0101010101010101ull) >> 56;
+#endif
+	}
+
+	// Transposes a 64x64 bit matrix in place, bit j of rows[i] moves to bit i of rows[j].
+	// Swaps the off-diagonal 32x32 blocks, then the 16x16 blocks within those and so on, 6 passes of 32 swaps.
+	inline void transpose_64x64(uint64_t* rows) {
+		uint64_t mask = 0x00000000FFFFFFFFull;
+		for (uint32_t width = 32; width != 0; width >>= 1, mask ^= mask << width) {
+			for (uint32_t i = 0; i < 64; i = ((i | width) + 1) & ~width) {
+				const uint64_t swap = ((rows[i] >> width) ^ rows[i | width]) & mask;
+				rows[i] ^= swap << width;
+				rows[i | width] ^= swap;
+			}
+		}
 	}
 }
\ No newline at end of file
@@ -191,6 +191,11 @@ public:
 	FN_DECIMAL GetPerlin(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
 	FN_DECIMAL GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
 
+	// Fills a grid of Perlin samples, out[(z * ySize + y) * xSize + x] = GetPerlin(xStart + x * step, yStart + y * step, zStart + z * step)
+	// Lattice gradients are looked up once per cell along each row instead of once per sample, and rows are evaluated 4 samples at a time with SSE2 when available
+	// Results match GetPerlin to within float rounding
+	void FillPerlinGrid(FN_DECIMAL* out, FN_DECIMAL xStart, FN_DECIMAL yStart, FN_DECIMAL zStart, int xSize, int ySize, int zSize, FN_DECIMAL step = 1) const;
+
 	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
 	FN_DECIMAL GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
 
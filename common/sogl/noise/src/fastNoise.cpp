@@ -33,6 +33,12 @@
 
 #include <algorithm>
 #include <random>
+#include <vector>
+
+#if !defined(FN_USE_DOUBLES) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define FN_GRID_SSE2
+#endif
 
 const FN_DECIMAL GRAD_X[] =
 {
@@ -875,6 +881,122 @@ FN_DECIMAL FastNoise::SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMA
 	return Lerp(yf0, yf1, zs);
 }
 
+static FN_DECIMAL InterpWeight(FastNoise::Interp interp, FN_DECIMAL t)
+{
+	switch (interp)
+	{
+	case FastNoise::Linear:
+		return t;
+	case FastNoise::Hermite:
+		return InterpHermiteFunc(t);
+	default:
+		return InterpQuinticFunc(t);
+	}
+}
+
+void FastNoise::FillPerlinGrid(FN_DECIMAL* out, FN_DECIMAL xStart, FN_DECIMAL yStart, FN_DECIMAL zStart, int xSize, int ySize, int zSize, FN_DECIMAL step) const
+{
+	if (xSize <= 0 || ySize <= 0 || zSize <= 0)
+		return;
+
+	// Cell, offset and weight along x are the same for every row
+	std::vector<int> xCell(xSize);
+	std::vector<FN_DECIMAL> xOffset(xSize);
+	std::vector<FN_DECIMAL> xWeight(xSize);
+	for (int x = 0; x < xSize; x++)
+	{
+		FN_DECIMAL xf = (xStart + (FN_DECIMAL)x * step) * m_frequency;
+		xCell[x] = FastFloor(xf);
+		xOffset[x] = xf - (FN_DECIMAL)xCell[x];
+		xWeight[x] = InterpWeight(m_interp, xOffset[x]);
+	}
+
+	for (int z = 0; z < zSize; z++)
+	{
+		FN_DECIMAL zf = (zStart + (FN_DECIMAL)z * step) * m_frequency;
+		int z0 = FastFloor(zf);
+		FN_DECIMAL zd0 = zf - (FN_DECIMAL)z0;
+		FN_DECIMAL zs = InterpWeight(m_interp, zd0);
+		unsigned char zPerm0 = m_perm[z0 & 0xff];
+		unsigned char zPerm1 = m_perm[(z0 + 1) & 0xff];
+
+		for (int y = 0; y < ySize; y++)
+		{
+			FN_DECIMAL yf = (yStart + (FN_DECIMAL)y * step) * m_frequency;
+			int y0 = FastFloor(yf);
+			FN_DECIMAL yd0 = yf - (FN_DECIMAL)y0;
+			FN_DECIMAL ys = InterpWeight(m_interp, yd0);
+
+			// The 4 cell edges along x, in the order y0z0, y1z0, y0z1, y1z1
+			unsigned char edgePerm[4] = {
+				m_perm[(y0 & 0xff) + zPerm0], m_perm[((y0 + 1) & 0xff) + zPerm0],
+				m_perm[(y0 & 0xff) + zPerm1], m_perm[((y0 + 1) & 0xff) + zPerm1] };
+			FN_DECIMAL edgeYd[4] = { yd0, yd0 - 1, yd0, yd0 - 1 };
+			FN_DECIMAL edgeZd[4] = { zd0, zd0, zd0 - 1, zd0 - 1 };
+
+			FN_DECIMAL* row = out + ((size_t)z * ySize + y) * xSize;
+			int x = 0;
+			while (x < xSize)
+			{
+				int x0 = xCell[x];
+				int end = x + 1;
+				while (end < xSize && xCell[end] == x0)
+					end++;
+
+				// Every sample in the run shares the cell's 8 gradients. Each gradient dot product is split into
+				// its x term and the y and z terms, which are constant along the row
+				FN_DECIMAL gx0[4], gx1[4], yz0[4], yz1[4];
+				for (int e = 0; e < 4; e++)
+				{
+					unsigned char lut0 = m_perm12[(x0 & 0xff) + edgePerm[e]];
+					unsigned char lut1 = m_perm12[((x0 + 1) & 0xff) + edgePerm[e]];
+					gx0[e] = GRAD_X[lut0];
+					gx1[e] = GRAD_X[lut1];
+					yz0[e] = edgeYd[e] * GRAD_Y[lut0] + edgeZd[e] * GRAD_Z[lut0];
+					yz1[e] = edgeYd[e] * GRAD_Y[lut1] + edgeZd[e] * GRAD_Z[lut1];
+				}
+
+#ifdef FN_GRID_SSE2
+				__m128 one = _mm_set1_ps(1);
+				__m128 ysV = _mm_set1_ps(ys);
+				__m128 zsV = _mm_set1_ps(zs);
+				for (; x + 4 <= end; x += 4)
+				{
+					__m128 xd0 = _mm_loadu_ps(&xOffset[x]);
+					__m128 xd1 = _mm_sub_ps(xd0, one);
+					__m128 xs = _mm_loadu_ps(&xWeight[x]);
+
+					__m128 xf[4];
+					for (int e = 0; e < 4; e++)
+					{
+						__m128 a = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(gx0[e]), xd0), _mm_set1_ps(yz0[e]));
+						__m128 b = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(gx1[e]), xd1), _mm_set1_ps(yz1[e]));
+						xf[e] = _mm_add_ps(a, _mm_mul_ps(xs, _mm_sub_ps(b, a)));
+					}
+
+					__m128 yf0 = _mm_add_ps(xf[0], _mm_mul_ps(ysV, _mm_sub_ps(xf[1], xf[0])));
+					__m128 yf1 = _mm_add_ps(xf[2], _mm_mul_ps(ysV, _mm_sub_ps(xf[3], xf[2])));
+					_mm_storeu_ps(row + x, _mm_add_ps(yf0, _mm_mul_ps(zsV, _mm_sub_ps(yf1, yf0))));
+				}
+#endif
+
+				for (; x < end; x++)
+				{
+					FN_DECIMAL xd0 = xOffset[x];
+					FN_DECIMAL xd1 = xd0 - 1;
+					FN_DECIMAL xs = xWeight[x];
+
+					FN_DECIMAL xf[4];
+					for (int e = 0; e < 4; e++)
+						xf[e] = Lerp(gx0[e] * xd0 + yz0[e], gx1[e] * xd1 + yz1[e], xs);
+
+					row[x] = Lerp(Lerp(xf[0], xf[1], ys), Lerp(xf[2], xf[3], ys), zs);
+				}
+			}
+		}
+	}
+}
+
 FN_DECIMAL FastNoise::GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	x *= m_frequency;
@@ -0,0 +1,68 @@
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#include <sogl/noise/fastNoise.h>
+#include <sogl/test/Test.h>
+
+// Largest difference between FillPerlinGrid and GetPerlin at every sample of the grid.
+static float GridError(const FastNoise& noise, const float xStart, const float yStart, const float zStart, const int xSize, const int ySize, const int zSize, const float step) {
+	std::vector<float> grid(xSize * ySize * zSize);
+	noise.FillPerlinGrid(grid.data(), xStart, yStart, zStart, xSize, ySize, zSize, step);
+
+	float error = 0.0f;
+	for (int z = 0; z < zSize; z++) {
+		for (int y = 0; y < ySize; y++) {
+			for (int x = 0; x < xSize; x++) {
+				const float scalar = noise.GetPerlin(xStart + x * step, yStart + y * step, zStart + z * step);
+				error = fmaxf(error, fabsf(scalar - grid[(z * ySize + y) * xSize + x]));
+			}
+		}
+	}
+
+	return error;
+}
+
+SOGL_TEST(FastNoise_GridMatchesScalar) {
+	FastNoise noise(1337);
+	const float origins[][3] = { { 0, 0, 0 }, { -64, -128, 64 }, { 6400, -64, -6400 }, { -1, -1, -1 } };
+	const FastNoise::Interp interps[] = { FastNoise::Linear, FastNoise::Hermite, FastNoise::Quintic };
+
+	for (const FastNoise::Interp interp : interps) {
+		noise.SetInterp(interp);
+
+		// whole chunks at the terrain frequency, on both sides of 0
+		noise.SetFrequency(0.01f);
+		for (const float* origin : origins) {
+			SOGL_CHECK(GridError(noise, origin[0], origin[1], origin[2], 64, 64, 64, 1.0f) < 1e-5f);
+		}
+
+		// odd sizes, fractional origins and steps, several samples per cell or several cells per sample
+		noise.SetFrequency(0.37f);
+		SOGL_CHECK(GridError(noise, 3.5f, -2.25f, 1.0f, 37, 11, 5, 0.5f) < 1e-5f);
+		SOGL_CHECK(GridError(noise, -7.0f, 0.125f, -3.0f, 3, 9, 2, 2.5f) < 1e-5f);
+	}
+}
+
+SOGL_BENCHMARK(FastNoise_GridAgainstScalar) {
+	FastNoise noise(1337);
+	noise.SetFrequency(0.01f);
+	std::vector<float> grid(64 * 64 * 64);
+
+	const double scalar = sogl::test::BestOf(10, [&]() {
+		for (int z = 0; z < 64; z++) {
+			for (int y = 0; y < 64; y++) {
+				for (int x = 0; x < 64; x++) {
+					grid[(z * 64 + y) * 64 + x] = noise.GetPerlin(64.0f + x, static_cast<float>(y), static_cast<float>(z));
+				}
+			}
+		}
+		sogl::test::DoNotOptimize(grid.data());
+	});
+	const double filled = sogl::test::BestOf(10, [&]() {
+		noise.FillPerlinGrid(grid.data(), 64.0f, 0.0f, 0.0f, 64, 64, 64);
+		sogl::test::DoNotOptimize(grid.data());
+	});
+
+	printf("  64^3 samples: GetPerlin %.0f us, FillPerlinGrid %.0f us (x%.1f)\n", scalar, filled, scalar / filled);
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <sogl/transform/matrix4f.hpp>
+#include <sogl/transform/vec3f.hpp>
+
+namespace sogl {
+	// Axis-aligned boxes stored by component, the layout Frustum::TestAABBs reads.
+	struct AABBList {
+		std::vector<float> minX, minY, minZ;
+		std::vector<float> maxX, maxY, maxZ;
+
+		inline void Clear() {
+			minX.clear(); minY.clear(); minZ.clear();
+			maxX.clear(); maxY.clear(); maxZ.clear();
+		}
+
+		inline void Add(const vec3f& min, const vec3f& max) {
+			minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+			maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+		}
+
+		inline uint32_t Size() const { return static_cast<uint32_t>(minX.size()); }
+	};
+
+	/// <summary>
+	/// <para>The six planes bounding what a camera can see, extracted from a view-projection matrix.</para>
+	/// <para>Box tests check the corner furthest along each plane's normal, so they never reject a visible box but
+	/// may keep a few just outside the frustum's edges. The planes are stored by component so TestAABBs can check
+	/// four boxes against a plane at once with SSE2.</para>
+	/// </summary>
+	class Frustum {
+	public:
+		static const uint32_t PLANE_COUNT = 6;
+	private:
+		// plane i holds the points where x * m_x[i] + y * m_y[i] + z * m_z[i] + m_w[i] >= 0, with unit normals.
+		// ordered left, right, bottom, top, near, far
+		float m_x[PLANE_COUNT];
+		float m_y[PLANE_COUNT];
+		float m_z[PLANE_COUNT];
+		float m_w[PLANE_COUNT];
+	public:
+		// Contains everything.
+		Frustum();
+		// viewProjection maps world space to clip space, e.g. camera::projectionMatrix * camera::viewMatrix.
+		explicit Frustum(const matrix4f& viewProjection);
+
+		bool TestSphere(const vec3f& center, const float radius) const;
+		bool TestAABB(const vec3f& min, const vec3f& max) const;
+		// Sets outVisible[i] to 1 if box i may be visible, 0 otherwise. outVisible must hold boxes.Size() entries.
+		void TestAABBs(const AABBList& boxes, uint8_t* outVisible) const;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <sogl/rendering/Frustum.h>
+
+namespace sogl {
+	struct renderable;
+
+	/// <summary>
+	/// <para>Collects renderables for a frame and draws the ones inside the view frustum.</para>
+	/// <para>World bounds are gathered when Flush() runs, so renderables may move between Submit() and Flush().</para>
+	/// </summary>
+	class RenderQueue {
+		std::vector<const renderable*> m_items;
+		AABBList m_bounds;
+		std::vector<uint8_t> m_visible;
+		uint32_t m_culledCount;
+	public:
+		RenderQueue();
+
+		void Submit(const renderable& item);
+		// Renders every submitted renderable whose bounds intersect frustum, in submission order, then empties the queue.
+		void Flush(const Frustum& frustum);
+
+		// Number of renderables skipped by the last Flush().
+		inline uint32_t CulledCount() const { return m_culledCount; }
+	};
+}
\ No newline at end of file
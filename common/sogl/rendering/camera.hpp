@@ -2,6 +2,7 @@
 
 #include <sogl/transform/matrix4f.hpp>
 #include <sogl/transform/vec3f.hpp>
+#include <sogl/rendering/Frustum.h>
 
 namespace sogl {
 	struct camera;
@@ -48,6 +49,8 @@ namespace sogl {
 		void regenerateViewMatrix();
 		void regenerateViewMatrix(const quat& rotation, const vec3f& position);
 		matrix4f inverseViewMatrix() const;
+		// The world-space view frustum of the current projection and view matrices.
+		Frustum getFrustum() const;
 
 		friend std::ostream& operator<<(std::ostream& os, const camera& camera);
 	} camera;
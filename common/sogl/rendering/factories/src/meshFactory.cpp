@@ -124,7 +124,7 @@ namespace sogl {
 		}
 		if (mesh->m_normals) {
 			delete[] mesh->m_normals;
-			mesh->m_texCoords = nullptr;
+			mesh->m_normals = nullptr;
 		}
 		if (mesh->m_indices) {
 			delete[] mesh->m_indices;
@@ -133,7 +133,7 @@ namespace sogl {
 		
 		for (uint64_t i = 0; i < LoadedMeshes.size; i++) {
 			char* key = nullptr;
-			if ((LoadedMeshes.data[i].key = key) == nullptr) continue;
+			if ((key = LoadedMeshes.data[i].key) == nullptr) continue;
 
 			else if (LoadedMeshes.data[i].value != mesh) continue;
 			
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <GLEW/glew.h>
 
 namespace sogl {
 	typedef struct GLMappedBuffer {
@@ -12,7 +13,10 @@ namespace sogl {
 		GLsync syncObj;
 	public:
 		GLMappedBuffer(const uint32_t size, const uint32_t flags, const void* data = nullptr);
+		// Waits for the GPU to finish the commands issued before the previous update, then fences the current ones.
 		void update();
+		// Unmaps and deletes the buffer.
+		void destroy();
 	};
 
 }
\ No newline at end of file
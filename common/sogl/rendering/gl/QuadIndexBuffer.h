@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace sogl {
+	/// <summary>
+	/// <para>Single element buffer shared by every quad mesh (0,1,2, 2,3,0 per quad).</para>
+	/// <para>Meshes only upload their four vertices per quad and bind this buffer into their VAO. The buffer grows
+	/// in place (same GL name) when a mesh needs more quads, so VAOs that already reference it stay valid.</para>
+	/// </summary>
+	class QuadIndexBuffer {
+		static uint32_t BufferID;
+		static uint32_t QuadCapacity;
+	public:
+		static const uint32_t INDICES_PER_QUAD = 6;
+		static const uint32_t VERTICES_PER_QUAD = 4;
+
+		static void Initialize(const uint32_t quadCount);
+		// Grows the buffer to at least quadCount quads. Must be called on the GL thread before drawing that many.
+		static void EnsureCapacity(const uint32_t quadCount);
+		// Binds to GL_ELEMENT_ARRAY_BUFFER, which attaches it to the currently bound VAO.
+		static void Bind();
+		static void Terminate();
+
+		// Writes the indices for quads [firstQuad, firstQuad + quadCount) into outIndices.
+		static void GenerateIndices(uint32_t* outIndices, const uint32_t firstQuad, const uint32_t quadCount);
+
+		inline static uint32_t Capacity() { return QuadCapacity; }
+		inline static uint32_t ID() { return BufferID; }
+	};
+}
\ No newline at end of file
@@ -3,23 +3,45 @@
 #include <sogl/rendering/gl/GLMappedBuffer.h>
 
 namespace sogl {
-	GLMappedBuffer::GLMappedBuffer(const uint32_t size, const uint32_t flags, const void* data) : syncObj() {
+	GLMappedBuffer::GLMappedBuffer(const uint32_t size, const uint32_t flags, const void* data) : syncObj(nullptr) {
 		this->flags = flags | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
 		this->size = size;
 		glGenBuffers(1, &ID);
 		glBindBuffer(GL_ARRAY_BUFFER, ID);
-		glBufferStorage(GL_ARRAY_BUFFER, size, data, flags);
-		this->pointer = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+		// storage has to be created with the persistent bits for the mapping below to be allowed
+		glBufferStorage(GL_ARRAY_BUFFER, size, data, this->flags);
+		this->pointer = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, this->flags);
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	void GLMappedBuffer::update() {
-		GLenum waitReturn = GL_UNSIGNALED;
-		while (waitReturn != GL_ALREADY_SIGNALED && waitReturn != GL_CONDITION_SATISFIED) {
-			waitReturn = glClientWaitSync(syncObj, GL_SYNC_FLUSH_COMMANDS_BIT, 1);
+		// nothing to wait for on the first update
+		if (syncObj != nullptr) {
+			GLenum waitReturn = GL_UNSIGNALED;
+			while (waitReturn != GL_ALREADY_SIGNALED && waitReturn != GL_CONDITION_SATISFIED) {
+				waitReturn = glClientWaitSync(syncObj, GL_SYNC_FLUSH_COMMANDS_BIT, 1);
+			}
+
+			glDeleteSync(syncObj);
 		}
 
-		glDeleteSync(syncObj);
 		syncObj = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 	}
+
+	void GLMappedBuffer::destroy() {
+		if (syncObj != nullptr) {
+			glDeleteSync(syncObj);
+			syncObj = nullptr;
+		}
+
+		if (ID != 0) {
+			glBindBuffer(GL_ARRAY_BUFFER, ID);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glDeleteBuffers(1, &ID);
+		}
+
+		ID = 0;
+		pointer = nullptr;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include <GLEW/glew.h>
+
+#include <vector>
+
+#include <sogl/rendering/gl/QuadIndexBuffer.h>
+
+namespace sogl {
+	uint32_t QuadIndexBuffer::BufferID = 0;
+	uint32_t QuadIndexBuffer::QuadCapacity = 0;
+
+	void QuadIndexBuffer::Initialize(const uint32_t quadCount) {
+		if (BufferID == 0) {
+			glGenBuffers(1, &BufferID);
+		}
+
+		EnsureCapacity(quadCount);
+	}
+
+	void QuadIndexBuffer::EnsureCapacity(const uint32_t quadCount) {
+		if (quadCount <= QuadCapacity)
+			return;
+
+		// grow geometrically so a stream of slightly bigger meshes doesn't regenerate every time
+		uint32_t capacity = QuadCapacity > 0 ? QuadCapacity : 1024;
+		while (capacity < quadCount) {
+			capacity *= 2;
+		}
+
+		std::vector<uint32_t> indices(capacity * INDICES_PER_QUAD);
+		GenerateIndices(indices.data(), 0, capacity);
+
+		// bind outside of any VAO so the currently bound one isn't modified
+		GLint boundVAO = 0;
+		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &boundVAO);
+		glBindVertexArray(0);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, BufferID);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+		glBindVertexArray(boundVAO);
+		QuadCapacity = capacity;
+	}
+
+	void QuadIndexBuffer::Bind() {
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, BufferID);
+	}
+
+	void QuadIndexBuffer::Terminate() {
+		if (BufferID != 0) {
+			glDeleteBuffers(1, &BufferID);
+		}
+
+		BufferID = 0;
+		QuadCapacity = 0;
+	}
+
+	void QuadIndexBuffer::GenerateIndices(uint32_t* outIndices, const uint32_t firstQuad, const uint32_t quadCount) {
+		for (uint32_t q = 0; q < quadCount; q++) {
+			const uint32_t base = (firstQuad + q) * VERTICES_PER_QUAD;
+			uint32_t* out = outIndices + q * INDICES_PER_QUAD;
+			out[0] = base;
+			out[1] = base + 1;
+			out[2] = base + 2;
+			out[3] = base + 2;
+			out[4] = base + 3;
+			out[5] = base;
+		}
+	}
+}
\ No newline at end of file
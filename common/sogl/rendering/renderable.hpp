@@ -15,11 +15,16 @@ namespace sogl {
 		transform transform;
 		Material* currentMaterial;
 		Texture* boundTexture;
+		// model-space bounding box of the mesh's positions
+		vec3f boundsMin;
+		vec3f boundsMax;
 
 		renderable(const Mesh& Mesh, Material* mat);
 		~renderable();
 		void render() const;
 		void addTexture(const std::string& filePath);
+		// The model-space bounds moved by the transform, grown to stay axis-aligned.
+		void getWorldBounds(vec3f& outMin, vec3f& outMax) const;
 
 		static void renderAll();
 	};
@@ -0,0 +1,102 @@
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOGL_FRUSTUM_SSE2
+#endif
+
+#include <sogl/rendering/Frustum.h>
+
+namespace sogl {
+	Frustum::Frustum() {
+		// 0 >= -1 everywhere
+		for (uint32_t i = 0; i < PLANE_COUNT; i++) {
+			m_x[i] = m_y[i] = m_z[i] = 0.0f;
+			m_w[i] = 1.0f;
+		}
+	}
+
+	Frustum::Frustum(const matrix4f& viewProjection) {
+		// a point is inside when -w <= x, y, z <= w in clip space, so each plane is the w row plus or minus another
+		const vec4f w = viewProjection.getRow(3);
+		for (uint32_t i = 0; i < PLANE_COUNT; i++) {
+			const vec4f row = viewProjection.getRow(i / 2);
+			const float sign = (i & 1) ? -1.0f : 1.0f;
+			const float x = w.x + row.x * sign;
+			const float y = w.y + row.y * sign;
+			const float z = w.z + row.z * sign;
+			const float d = w.w + row.w * sign;
+
+			// normalized so sphere tests can compare against the radius directly
+			const float length = sqrtf(x * x + y * y + z * z);
+			const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+			m_x[i] = x * scale;
+			m_y[i] = y * scale;
+			m_z[i] = z * scale;
+			m_w[i] = d * scale;
+		}
+	}
+
+	bool Frustum::TestSphere(const vec3f& center, const float radius) const {
+		for (uint32_t i = 0; i < PLANE_COUNT; i++) {
+			if (center.x * m_x[i] + center.y * m_y[i] + center.z * m_z[i] + m_w[i] < -radius)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool Frustum::TestAABB(const vec3f& min, const vec3f& max) const {
+		for (uint32_t i = 0; i < PLANE_COUNT; i++) {
+			// the corner furthest inside; if even that is outside, so is the whole box
+			const float x = m_x[i] >= 0.0f ? max.x : min.x;
+			const float y = m_y[i] >= 0.0f ? max.y : min.y;
+			const float z = m_z[i] >= 0.0f ? max.z : min.z;
+			if (x * m_x[i] + y * m_y[i] + z * m_z[i] + m_w[i] < 0.0f)
+				return false;
+		}
+
+		return true;
+	}
+
+	void Frustum::TestAABBs(const AABBList& boxes, uint8_t* outVisible) const {
+		const uint32_t count = boxes.Size();
+		uint32_t i = 0;
+
+#ifdef SOGL_FRUSTUM_SSE2
+		// four boxes per iteration. which corner to test only depends on the plane, so it picks whole vectors
+		for (; i + 4 <= count; i += 4) {
+			const __m128 minX = _mm_loadu_ps(boxes.minX.data() + i);
+			const __m128 minY = _mm_loadu_ps(boxes.minY.data() + i);
+			const __m128 minZ = _mm_loadu_ps(boxes.minZ.data() + i);
+			const __m128 maxX = _mm_loadu_ps(boxes.maxX.data() + i);
+			const __m128 maxY = _mm_loadu_ps(boxes.maxY.data() + i);
+			const __m128 maxZ = _mm_loadu_ps(boxes.maxZ.data() + i);
+
+			__m128 outside = _mm_setzero_ps();
+			for (uint32_t plane = 0; plane < PLANE_COUNT; plane++) {
+				const __m128 x = m_x[plane] >= 0.0f ? maxX : minX;
+				const __m128 y = m_y[plane] >= 0.0f ? maxY : minY;
+				const __m128 z = m_z[plane] >= 0.0f ? maxZ : minZ;
+
+				__m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m_x[plane])), _mm_set1_ps(m_w[plane]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(m_y[plane])));
+				distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(m_z[plane])));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+			}
+
+			const int mask = _mm_movemask_ps(outside);
+			outVisible[i] = (mask & 1) == 0;
+			outVisible[i + 1] = (mask & 2) == 0;
+			outVisible[i + 2] = (mask & 4) == 0;
+			outVisible[i + 3] = (mask & 8) == 0;
+		}
+#endif
+
+		for (; i < count; i++) {
+			outVisible[i] = TestAABB(
+				vec3f(boxes.minX[i], boxes.minY[i], boxes.minZ[i]),
+				vec3f(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i])) ? 1 : 0;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include <sogl/rendering/RenderQueue.h>
+#include <sogl/rendering/renderable.hpp>
+
+namespace sogl {
+	RenderQueue::RenderQueue() : m_items(), m_bounds(), m_visible(), m_culledCount(0) {}
+
+	void RenderQueue::Submit(const renderable& item) {
+		m_items.push_back(&item);
+	}
+
+	void RenderQueue::Flush(const Frustum& frustum) {
+		m_bounds.Clear();
+		for (const renderable* item : m_items) {
+			vec3f min, max;
+			item->getWorldBounds(min, max);
+			m_bounds.Add(min, max);
+		}
+
+		m_visible.resize(m_items.size());
+		frustum.TestAABBs(m_bounds, m_visible.data());
+
+		m_culledCount = 0;
+		for (size_t i = 0; i < m_items.size(); i++) {
+			if (m_visible[i]) {
+				m_items[i]->render();
+			}
+			else {
+				m_culledCount++;
+			}
+		}
+
+		m_items.clear();
+	}
+}
\ No newline at end of file
@@ -144,6 +144,10 @@ namespace sogl {
 		return invView;
 	}
 
+	Frustum camera::getFrustum() const {
+		return Frustum(projectionMatrix * viewMatrix);
+	}
+
 	std::ostream& operator<<(std::ostream& os, const camera& cam) {
 		os << "[CAMERA]\n";
 		quat y(cam.yaw, vec3f::UP);
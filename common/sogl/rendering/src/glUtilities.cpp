@@ -12,7 +12,9 @@
 #include <sogl/rendering/camera.hpp>
 #include <sogl/transform/vec3f.hpp>
 #include <sogl/debug/debug.h>
-#include <sogl/world/data/chunk.h>
+#include <sogl/world/data/chunkMesh.h>
+#include <sogl/world/data/ChunkArena.h>
+#include <sogl/rendering/gl/QuadIndexBuffer.h>
 
 static void GLFWDefaultErrorCallback(int error, const char* msg) {
 	fprintf(stderr,
@@ -116,7 +118,15 @@ namespace sogl {
 		glfwMaximizeWindow(CurrentInstance.window);
 		
 		debug::setup();
-		Chunk::initialize();
+		ChunkMesh::Initialize();
+
+		// enough for a typical surface chunk, grows on demand
+		QuadIndexBuffer::Initialize(16384);
+		glAddTerminationFunction(QuadIndexBuffer::Terminate);
+
+		// 16 MB of vertices to start with, both grow on demand
+		ChunkArena::Initialize(4 * 1024 * 1024, 1024);
+		glAddTerminationFunction(ChunkArena::Terminate);
 		return CurrentInstance.window;
 	}
 
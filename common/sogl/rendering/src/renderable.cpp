@@ -1,5 +1,6 @@
 #include <GLEW/glew.h>
 #include <GLFW/glfw3.h>
+#include <math.h>
 #include <iostream>
 
 #include <sogl/structure/hashTable.hpp>
@@ -19,6 +20,17 @@ namespace sogl {
 		this->boundTexture = nullptr;
 		this->currentMaterial = mat;
 		this->transform = sogl::transform();
+
+		// positions are packed xyz
+		const float* positions = Mesh.Vertices();
+		const uint32_t count = positions != nullptr ? Mesh.VertexCount() / 3 : 0;
+		boundsMin = count > 0 ? vec3f(positions[0], positions[1], positions[2]) : vec3f::ZERO;
+		boundsMax = boundsMin;
+		for (uint32_t i = 1; i < count; i++) {
+			const float* p = positions + i * 3;
+			boundsMin = vec3f(fminf(boundsMin.x, p[0]), fminf(boundsMin.y, p[1]), fminf(boundsMin.z, p[2]));
+			boundsMax = vec3f(fmaxf(boundsMax.x, p[0]), fmaxf(boundsMax.y, p[1]), fmaxf(boundsMax.z, p[2]));
+		}
 	}
 
 	renderable::~renderable() {
@@ -54,6 +66,22 @@ namespace sogl {
 		boundTexture = new Texture(filePath.c_str());
 	}
 
+	void renderable::getWorldBounds(vec3f& outMin, vec3f& outMax) const {
+		const matrix4f m = transform.getTransformationMatrix();
+		const vec3f center = (boundsMin + boundsMax) * 0.5f;
+		const vec3f extent = (boundsMax - boundsMin) * 0.5f;
+
+		// each world axis reaches as far as the rotated extents add up along it
+		const vec3f worldCenter = m * center;
+		vec3f worldExtent;
+		worldExtent.x = fabsf(m(0, 0)) * extent.x + fabsf(m(1, 0)) * extent.y + fabsf(m(2, 0)) * extent.z;
+		worldExtent.y = fabsf(m(0, 1)) * extent.x + fabsf(m(1, 1)) * extent.y + fabsf(m(2, 1)) * extent.z;
+		worldExtent.z = fabsf(m(0, 2)) * extent.x + fabsf(m(1, 2)) * extent.y + fabsf(m(2, 2)) * extent.z;
+
+		outMin = worldCenter - worldExtent;
+		outMax = worldCenter + worldExtent;
+	}
+
 	void renderable::renderAll() {
 
 	}
@@ -14,5 +14,20 @@ namespace sogl {
 
 			return hash;
 		}
+
+		// splitmix64 finalizer, every input bit affects every output bit
+		static inline uint64_t Mix64(uint64_t x) {
+			x ^= x >> 30;
+			x *= 0xBF58476D1CE4E5B9;
+			x ^= x >> 27;
+			x *= 0x94D049BB133111EB;
+			x ^= x >> 31;
+			return x;
+		}
+
+		// Order-dependent, so Combine(Combine(s, a), b) != Combine(Combine(s, b), a).
+		static inline uint64_t Combine(const uint64_t seed, const uint64_t value) {
+			return Mix64(seed ^ (value + 0x9E3779B97F4A7C15 + (seed << 6) + (seed >> 2)));
+		}
 	}
 }
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+namespace sogl {
+	/// <summary>
+	/// <para>Hands out ranges of a linear address space, e.g. offsets into one large GPU buffer.</para>
+	/// <para>Free ranges are indexed by offset, so a freed range merges with the free ranges on either side of it
+	/// straight away, and by size, so allocation takes the smallest free range that fits. Ranges can start on any
+	/// power of two alignment, and can be resized in place when the space after them allows it.</para>
+	/// <para>Compact() works through the free ranges from the bottom, sliding allocations down into them or moving
+	/// them out of the way, a few at a time, so a buffer can be defragmented over several frames. Only the
+	/// bookkeeping lives here, the memory being described is never touched, so it works (and can be tested)
+	/// without a GL context.</para>
+	/// </summary>
+	class RangeAllocator {
+	public:
+		static const uint32_t INVALID_OFFSET = 0xFFFFFFFF;
+
+		// A range Compact() relocated. The data at from should be copied to to, after which from must be freed. to
+		// is below from and the two overlap when a range slid down into a smaller free range, so the copy has to
+		// work like memmove.
+		struct Move {
+			uint32_t from;
+			uint32_t to;
+			uint32_t size;
+		};
+
+	private:
+		// highest allocations Compact() tries to fill each free range with
+		static const uint32_t COMPACT_FILL_CANDIDATES = 32;
+
+		struct Allocation {
+			uint32_t size;
+			// copied elsewhere by Compact(), or pinned, and waiting for the caller to free it
+			bool pinned;
+			// units at the front now belonging to the copy that slid over them, Free() only releases the rest
+			uint32_t overlap;
+		};
+
+		// offset -> size
+		std::map<uint32_t, uint32_t> m_freeRanges;
+		// size -> offset, the same ranges for best-fit lookups
+		std::multimap<uint32_t, uint32_t> m_freeBySize;
+		// offset -> allocation, ordered so Compact() can walk down from the top
+		std::map<uint32_t, Allocation> m_allocations;
+		uint32_t m_capacity;
+		uint32_t m_usedSize;
+		// the last Compact() moved nothing, so the next one can't either until something is allocated or freed
+		bool m_compactStalled;
+
+		static inline uint32_t AlignUp(const uint32_t offset, const uint32_t alignment) {
+			return (offset + alignment - 1) & ~(alignment - 1);
+		}
+
+		void AddFreeRange(const uint32_t offset, const uint32_t size);
+		void RemoveFreeRange(std::map<uint32_t, uint32_t>::iterator range);
+		// Adds a range to the free set, merged with the free ranges touching it.
+		void InsertFreeRange(uint32_t offset, uint32_t size);
+		// Takes [offset, offset + size) out of the free range starting at rangeOffset, which must contain it.
+		void Carve(const uint32_t rangeOffset, const uint32_t offset, const uint32_t size);
+		// Allocates a copy of allocation at to, inside the free range at rangeOffset, and records the move.
+		void MoveAllocation(std::map<uint32_t, Allocation>::iterator allocation, const uint32_t rangeOffset, const uint32_t to, std::vector<Move>& outMoves);
+		// Moves allocation down to to, in the free range at rangeOffset that ends where it starts, but is too small
+		// to hold it. The copy takes over the front of allocation, so only the free part is carved.
+		void SlideAllocation(std::map<uint32_t, Allocation>::iterator allocation, const uint32_t rangeOffset, const uint32_t to, std::vector<Move>& outMoves);
+	public:
+		explicit RangeAllocator(const uint32_t capacity = 0);
+
+		// Returns the offset of a new range of size units starting on a multiple of alignment (a power of two), or
+		// INVALID_OFFSET if size is 0 or no free range fits.
+		uint32_t Allocate(const uint32_t size, const uint32_t alignment = 1);
+		// Releases a range returned by Allocate. Unknown offsets are ignored.
+		void Free(const uint32_t offset);
+		// Shrinks or grows the range at offset without moving it. Returns false, leaving it as it was, if newSize is
+		// 0, the range isn't allocated or has been moved, or the space after it isn't free.
+		bool Resize(const uint32_t offset, const uint32_t newSize);
+		// Keeps Compact() from moving the range at offset, for ranges that are only waiting to be freed. Resize()
+		// refuses it from then on, like a moved range.
+		void Pin(const uint32_t offset);
+		// Extends the address space to capacity, the new space at the end is free. Never shrinks.
+		void Grow(const uint32_t capacity);
+		// Frees everything.
+		void Reset(const uint32_t capacity);
+
+		// Plans moves that pack allocations towards offset 0, until maxSize units have been moved. The first move
+		// may be larger on its own, so a big range can't hold compaction up. Each destination is allocated straight
+		// away. The source stays allocated, and is never moved again, until the caller frees it, so it can keep
+		// being read until the copy is done. Returns the number of units moved. Once a call moves nothing, the
+		// following ones return 0 straight away until the next Allocate, Free, Resize or Grow.
+		uint32_t Compact(const uint32_t maxSize, std::vector<Move>& outMoves, const uint32_t alignment = 1);
+
+		// Size of the range at offset, 0 if it isn't allocated.
+		uint32_t SizeOf(const uint32_t offset) const;
+		uint32_t LargestFreeRange() const;
+		// 0 when all free space is a single range, approaching 1 as it splits into many small ones.
+		float Fragmentation() const;
+
+		inline uint32_t Capacity() const { return m_capacity; }
+		inline uint32_t UsedSize() const { return m_usedSize; }
+		inline uint32_t AllocationCount() const { return static_cast<uint32_t>(m_allocations.size()); }
+		inline uint32_t FreeRangeCount() const { return static_cast<uint32_t>(m_freeRanges.size()); }
+	};
+}
\ No newline at end of file
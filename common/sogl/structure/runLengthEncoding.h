@@ -1,100 +1,217 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
-#include <iostream>
-#include <sogl/structure/linkedList.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <sogl/bitmanip.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOGL_RLE_SSE2
+#endif
 
 namespace sogl {
+	/// <summary>
+	/// <para>Run-length encoded copy of a flat array, stored in a single contiguous byte buffer.</para>
+	/// <para>Each run is the raw bytes of its value followed by the run length as a little-endian base-128
+	/// varint, so runs shorter than 128 cost sizeof(T) + 1 bytes. The buffer has no padding and can be written
+	/// to disk as is. Byte-sized values find run boundaries 16 at a time with SSE2.</para>
+	/// </summary>
 	template<typename T>
 	class runLengthEncoding {
-		struct RLENode {
-			T object;
-			uint32_t runLength;
-			
-			RLENode() {
-				runLength = 0;
+		static_assert(std::is_trivially_copyable<T>::value, "runLengthEncoding values are stored as raw bytes");
+
+		std::vector<uint8_t> m_data;
+		uint32_t m_count;
+		uint32_t m_runCount;
+
+		inline void appendRun(const T& value, uint32_t length) {
+			uint8_t bytes[sizeof(T) + 5];
+			memcpy(bytes, &value, sizeof(T));
+
+			uint32_t size = sizeof(T);
+			while (length >= 0x80) {
+				bytes[size++] = static_cast<uint8_t>(length) | 0x80;
+				length >>= 7;
 			}
+			bytes[size++] = static_cast<uint8_t>(length);
+
+			m_data.insert(m_data.end(), bytes, bytes + size);
+			m_runCount++;
+		}
 
-			RLENode(uint32_t runLength, T object) {
-				this->runLength = runLength;
-				this->object = object;
+		// Appends the runs from runStart up to count, except the last one, comparing from values[from] on.
+		// Returns the index that run starts at.
+		inline uint32_t encodeRuns(const T* values, const uint32_t from, const uint32_t count, uint32_t runStart) {
+			for (uint32_t i = from > runStart ? from : runStart + 1; i < count; i++) {
+				if (memcmp(&values[i], &values[runStart], sizeof(T)) != 0) {
+					appendRun(values[runStart], i - runStart);
+					runStart = i;
+				}
 			}
-		};
-	public:
-		typedef bool (*comparer)(const T& a, const T& b);
-	private:
-		linkedList<RLENode> m_data;
-		uint32_t m_totalLength;
-		comparer m_comp;
-	public:
-		inline runLengthEncoding() : m_data(), m_totalLength(0) {}
-		inline runLengthEncoding(T* objArray, const uint32_t arraySize, comparer comp) : m_data(), m_totalLength(0), m_comp(comp) {
-			if (arraySize <= 0) return;
-			else if (m_comp == nullptr) return;
 
-			encode(objArray, arraySize);
+			return runStart;
+		}
+	public:
+		inline runLengthEncoding() : m_data(), m_count(0), m_runCount(0) {}
+		inline runLengthEncoding(const T* values, const uint32_t count) : m_data(), m_count(0), m_runCount(0) {
+			encode(values, count);
 		}
 
-		void add(T obj) {
-			if (m_data.last() && m_data.last()->object == obj) {
-				m_data.last()->runLength++;
+		// Replaces the contents with the runs of values[0, count).
+		void encode(const T* values, const uint32_t count) {
+			m_data.clear();
+			m_count = count;
+			m_runCount = 0;
+			if (count == 0)
 				return;
+
+			uint32_t runStart = 0;
+			// values before this are known to belong to the run at runStart or an earlier one
+			uint32_t scanned = 0;
+#ifdef SOGL_RLE_SSE2
+			if (sizeof(T) == 1) {
+				// compare each block against itself shifted by one, every clear bit in the mask ends a run
+				const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+				uint32_t i = 0;
+				for (; i + 17 <= count; i += 16) {
+					const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+					const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 1));
+					uint32_t boundaries = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(current, next))) & 0xFFFF;
+
+					while (boundaries != 0) {
+						const uint32_t end = i + static_cast<uint32_t>(trailing_zeroes(boundaries)) + 1;
+						boundaries &= boundaries - 1;
+
+						appendRun(values[runStart], end - runStart);
+						runStart = end;
+					}
+				}
+				scanned = i;
 			}
+#endif
 
-			m_data.add(RLENode(1, obj));
-			m_totalLength++;
+			// the tail starts where the blocks stopped, not back at the start of a run that may span all of them
+			runStart = encodeRuns(values, scanned, count, runStart);
+			appendRun(values[runStart], count - runStart);
 		}
 
-		void encode(T* objArray, const uint32_t arraySize) {
-			if (arraySize <= 0) return;
-
-			T* prev = const_cast<T*>(&objArray[0]);
-			T* curr = nullptr;
-
-			uint32_t run = 0;
-			uint32_t index = 1;
-			while ((curr = &objArray[index]) != nullptr && index <= arraySize) {
-				index++;
-				run++;
-				if (!m_comp(*prev, *curr)) {
-					RLENode rle(run, *prev);
-					m_data.add(rle);
-					m_totalLength += run;
-					run = 0;
-					prev = curr;
-					continue;
+		// Decodes into outValues, which must hold count values. Returns false if the data is malformed or
+		// doesn't decode to exactly count values.
+		bool decode(T* outValues, const uint32_t count) const {
+			if (count != m_count)
+				return false;
+
+			const uint8_t* read = m_data.data();
+			const uint8_t* end = read + m_data.size();
+			uint32_t written = 0;
+
+			while (read < end) {
+				if (end - read < static_cast<ptrdiff_t>(sizeof(T) + 1))
+					return false;
+
+				T value;
+				memcpy(&value, read, sizeof(T));
+				read += sizeof(T);
+
+				uint32_t length = 0;
+				uint32_t shift = 0;
+				while (true) {
+					if (read == end || shift > 28)
+						return false;
+
+					const uint8_t byte = *read++;
+					length |= static_cast<uint32_t>(byte & 0x7F) << shift;
+					shift += 7;
+					if ((byte & 0x80) == 0)
+						break;
 				}
 
-				
+				if (length == 0 || length > count - written)
+					return false;
+
+				if (sizeof(T) == 1) {
+					memset(outValues + written, *reinterpret_cast<const uint8_t*>(&value), length);
+				}
+				else {
+					std::fill(outValues + written, outValues + written + length, value);
+				}
+				written += length;
 			}
+
+			return written == count;
 		}
 
-		bool writeToFile(const char* filePath, const char* fileExtension) {
+		// Takes over an encoded buffer, e.g. read back from disk. It is validated on decode().
+		void assign(const uint8_t* data, const uint32_t size, const uint32_t count, const uint32_t runCount = 0) {
+			m_data.assign(data, data + size);
+			m_count = count;
+			m_runCount = runCount;
+		}
+
+		void clear() {
+			m_data.clear();
+			m_data.shrink_to_fit();
+			m_count = 0;
+			m_runCount = 0;
+		}
+
+		inline const std::vector<uint8_t>& data() const { return m_data; }
+		// Number of values the data decodes to.
+		inline uint32_t count() const { return m_count; }
+		inline uint32_t runCount() const { return m_runCount; }
+		inline uint64_t memoryUsage() const { return m_data.capacity(); }
+
+		bool writeToFile(const char* filePath, const char* fileExtension) const {
 			char buf[256];
 			snprintf(buf, sizeof(buf), "%s%s", filePath, fileExtension);
 
 			FILE* file = fopen(buf, "wb");
-
 			if (file == nullptr) {
-				printf("Could not write to file! Resulting path: %s", buf);
+				printf("Could not write to file! Resulting path: %s\n", buf);
 				return false;
 			}
 
-			RLENode* current = nullptr;
-			uint32_t index = 0;
-			RLENode* nodeArr = nullptr;
-			m_data.toArray(nodeArr);
+			// value count, then the runs
+			const bool written = fwrite(&m_count, sizeof(m_count), 1, file) == 1
+				&& fwrite(m_data.data(), 1, m_data.size(), file) == m_data.size();
+			fclose(file);
+
+			return written;
+		}
+
+		bool readFromFile(const char* filePath, const char* fileExtension) {
+			char buf[256];
+			snprintf(buf, sizeof(buf), "%s%s", filePath, fileExtension);
 
-			fwrite(nodeArr, sizeof(RLENode), m_data.size(), file);
-			//while (index < m_data.size()) {
-			//	current = &m_data[index++];
-			//	fwrite(&current->object, sizeof(T), 1, file);
-			//	fwrite(&current->runLength, sizeof(uint32_t), 1, file);
-			//}
+			FILE* file = fopen(buf, "rb");
+			if (file == nullptr) {
+				printf("Could not read file! Resulting path: %s\n", buf);
+				return false;
+			}
 
+			fseek(file, 0, SEEK_END);
+			const long size = ftell(file);
+			fseek(file, 0, SEEK_SET);
+
+			uint32_t count = 0;
+			std::vector<uint8_t> data(size > static_cast<long>(sizeof(count)) ? size - sizeof(count) : 0);
+			const bool read = size >= static_cast<long>(sizeof(count))
+				&& fread(&count, sizeof(count), 1, file) == 1
+				&& fread(data.data(), 1, data.size(), file) == data.size();
 			fclose(file);
-			printf("Finished writing binary file! Output:\n");
-			printf(buf);
+
+			if (!read)
+				return false;
+
+			m_data.swap(data);
+			m_count = count;
+			m_runCount = 0;
+			return true;
 		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include <assert.h>
+#include <iterator>
+
+#include <sogl/structure/RangeAllocator.h>
+
+namespace sogl {
+	RangeAllocator::RangeAllocator(const uint32_t capacity) : m_freeRanges(), m_freeBySize(), m_allocations(), m_capacity(0), m_usedSize(0), m_compactStalled(false) {
+		Reset(capacity);
+	}
+
+	uint32_t RangeAllocator::Allocate(const uint32_t size, const uint32_t alignment) {
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+		if (size == 0)
+			return INVALID_OFFSET;
+
+		// smallest first. padding for the alignment may rule a range out, so keep going up until one fits
+		for (auto it = m_freeBySize.lower_bound(size); it != m_freeBySize.end(); ++it) {
+			const uint32_t rangeOffset = it->second;
+			const uint32_t offset = AlignUp(rangeOffset, alignment);
+			if (offset - rangeOffset + size > it->first)
+				continue;
+
+			Carve(rangeOffset, offset, size);
+			m_allocations.emplace(offset, Allocation{ size, false, 0 });
+			m_usedSize += size;
+			m_compactStalled = false;
+			return offset;
+		}
+
+		return INVALID_OFFSET;
+	}
+
+	void RangeAllocator::Free(const uint32_t offset) {
+		auto it = m_allocations.find(offset);
+		if (it == m_allocations.end())
+			return;
+
+		// the front of a slid range is the copy's now
+		const uint32_t overlap = it->second.overlap;
+		const uint32_t size = it->second.size - overlap;
+		m_allocations.erase(it);
+		m_usedSize -= size;
+		m_compactStalled = false;
+		InsertFreeRange(offset + overlap, size);
+	}
+
+	bool RangeAllocator::Resize(const uint32_t offset, const uint32_t newSize) {
+		auto it = m_allocations.find(offset);
+		if (newSize == 0 || it == m_allocations.end() || it->second.pinned)
+			return false;
+
+		const uint32_t size = it->second.size;
+		if (newSize <= size) {
+			if (newSize < size) {
+				InsertFreeRange(offset + newSize, size - newSize);
+			}
+		}
+		else {
+			// only if the range right after this one is free and big enough
+			auto next = m_freeRanges.find(offset + size);
+			if (next == m_freeRanges.end() || next->second < newSize - size)
+				return false;
+
+			Carve(next->first, offset + size, newSize - size);
+		}
+
+		it->second.size = newSize;
+		m_usedSize = m_usedSize - size + newSize;
+		m_compactStalled = false;
+		return true;
+	}
+
+	void RangeAllocator::Pin(const uint32_t offset) {
+		auto it = m_allocations.find(offset);
+		if (it != m_allocations.end()) {
+			it->second.pinned = true;
+		}
+	}
+
+	void RangeAllocator::Grow(const uint32_t capacity) {
+		if (capacity <= m_capacity)
+			return;
+
+		const uint32_t oldCapacity = m_capacity;
+		m_capacity = capacity;
+		m_compactStalled = false;
+		InsertFreeRange(oldCapacity, capacity - oldCapacity);
+	}
+
+	void RangeAllocator::Reset(const uint32_t capacity) {
+		m_freeRanges.clear();
+		m_freeBySize.clear();
+		m_allocations.clear();
+		m_capacity = capacity;
+		m_usedSize = 0;
+		m_compactStalled = false;
+
+		if (capacity > 0) {
+			AddFreeRange(0, capacity);
+		}
+	}
+
+	uint32_t RangeAllocator::Compact(const uint32_t maxSize, std::vector<Move>& outMoves, const uint32_t alignment) {
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+		if (m_compactStalled)
+			return 0;
+
+		const size_t firstMove = outMoves.size();
+		uint32_t moved = 0;
+
+		// free ranges from the bottom up. each one is filled, or the allocation after it moves away, so once the
+		// sources are freed it has moved up or grown. with an alignment of 1, repeated calls end with all the free
+		// space in one range at the top. larger alignments can leave padding behind.
+		uint32_t cursor = 0;
+		while (moved < maxSize) {
+			auto hole = m_freeRanges.lower_bound(cursor);
+			if (hole == m_freeRanges.end())
+				break;
+
+			const uint32_t holeOffset = hole->first;
+			const uint32_t holeSize = hole->second;
+			cursor = holeOffset + holeSize;
+
+			// free ranges are merged, so the next thing up is an allocation, the end of the space, or what's left of a
+			// slid source whose copy was freed first, which is waiting to be freed as well
+			auto next = m_allocations.find(cursor);
+			if (next == m_allocations.end()) {
+				if (cursor >= m_capacity)
+					break;
+
+				continue;
+			}
+
+			// the waiting source of an earlier move, this range grows by itself once that is freed
+			if (next->second.pinned)
+				continue;
+
+			// only alignment padding, nothing could ever be moved in
+			const uint32_t to = AlignUp(holeOffset, alignment);
+			if (to >= cursor)
+				continue;
+
+			auto withinBudget = [&](const uint32_t size) {
+				return moved == 0 || moved + size <= maxSize;
+			};
+			auto fits = [&](const uint32_t size) {
+				return withinBudget(size) && to - holeOffset + size <= holeSize;
+			};
+
+			// fill the range from the top, looking at a few of the highest allocations. these won't have to move again
+			bool filled = false;
+			auto candidate = m_allocations.end();
+			for (uint32_t i = 0; i < COMPACT_FILL_CANDIDATES && candidate != m_allocations.begin(); i++) {
+				--candidate;
+				if (candidate->first <= cursor)
+					break;
+
+				if (!candidate->second.pinned && fits(candidate->second.size)) {
+					MoveAllocation(candidate, holeOffset, to, outMoves);
+					moved += candidate->second.size;
+					filled = true;
+					break;
+				}
+			}
+			if (filled)
+				continue;
+
+			// otherwise slide the next allocation down. it fits below its old place, so the two never overlap
+			if (fits(next->second.size)) {
+				MoveAllocation(next, holeOffset, to, outMoves);
+				moved += next->second.size;
+				continue;
+			}
+
+			const uint32_t size = next->second.size;
+			if (!withinBudget(size))
+				continue;
+
+			// nothing fits, so move the allocation in the way up to the smallest free range above it that holds it
+			bool evacuated = false;
+			for (auto range = m_freeBySize.lower_bound(size); range != m_freeBySize.end(); ++range) {
+				const uint32_t rangeTo = AlignUp(range->second, alignment);
+				if (range->second < cursor || rangeTo - range->second + size > range->first)
+					continue;
+
+				MoveAllocation(next, range->second, rangeTo, outMoves);
+				evacuated = true;
+				break;
+			}
+
+			// or, when there's no room anywhere, slide it down over its own front. this always works, so the lowest
+			// free range keeps moving up even in an almost full space
+			if (!evacuated) {
+				SlideAllocation(next, holeOffset, to, outMoves);
+			}
+			moved += size;
+		}
+
+		// destinations only had to be kept out of this pass
+		for (size_t i = firstMove; i < outMoves.size(); i++) {
+			m_allocations[outMoves[i].to].pinned = false;
+		}
+
+		m_compactStalled = moved == 0;
+		return moved;
+	}
+
+	void RangeAllocator::MoveAllocation(std::map<uint32_t, Allocation>::iterator allocation, const uint32_t rangeOffset, const uint32_t to, std::vector<Move>& outMoves) {
+		const uint32_t size = allocation->second.size;
+		Carve(rangeOffset, to, size);
+
+		// the source stays allocated until the caller frees it. the destination is marked too, so the rest of the
+		// pass leaves it alone
+		m_allocations.emplace(to, Allocation{ size, true, 0 });
+		allocation->second.pinned = true;
+		m_usedSize += size;
+		outMoves.push_back(Move{ allocation->first, to, size });
+	}
+
+	void RangeAllocator::SlideAllocation(std::map<uint32_t, Allocation>::iterator allocation, const uint32_t rangeOffset, const uint32_t to, std::vector<Move>& outMoves) {
+		const uint32_t from = allocation->first;
+		const uint32_t size = allocation->second.size;
+		Carve(rangeOffset, to, from - to);
+
+		// only the free part counts as newly used, the overlap is handed from the source to the copy
+		m_allocations.emplace(to, Allocation{ size, true, 0 });
+		allocation->second.pinned = true;
+		allocation->second.overlap = to + size - from;
+		m_usedSize += from - to;
+		outMoves.push_back(Move{ from, to, size });
+	}
+
+	uint32_t RangeAllocator::SizeOf(const uint32_t offset) const {
+		auto it = m_allocations.find(offset);
+		return it != m_allocations.end() ? it->second.size : 0;
+	}
+
+	uint32_t RangeAllocator::LargestFreeRange() const {
+		return m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first;
+	}
+
+	float RangeAllocator::Fragmentation() const {
+		const uint32_t freeSize = m_capacity - m_usedSize;
+		if (freeSize == 0)
+			return 0.0f;
+
+		return 1.0f - static_cast<float>(LargestFreeRange()) / freeSize;
+	}
+
+	void RangeAllocator::AddFreeRange(const uint32_t offset, const uint32_t size) {
+		m_freeRanges.emplace(offset, size);
+		m_freeBySize.emplace(size, offset);
+	}
+
+	void RangeAllocator::RemoveFreeRange(std::map<uint32_t, uint32_t>::iterator range) {
+		// ranges never overlap, so only one entry of that size has this offset
+		auto bySize = m_freeBySize.equal_range(range->second);
+		for (auto it = bySize.first; it != bySize.second; ++it) {
+			if (it->second == range->first) {
+				m_freeBySize.erase(it);
+				break;
+			}
+		}
+
+		m_freeRanges.erase(range);
+	}
+
+	void RangeAllocator::InsertFreeRange(uint32_t offset, uint32_t size) {
+		// merge with the free range ending where this one starts
+		auto next = m_freeRanges.lower_bound(offset);
+		if (next != m_freeRanges.begin()) {
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == offset) {
+				offset = previous->first;
+				size += previous->second;
+				RemoveFreeRange(previous);
+			}
+		}
+
+		// and with the one starting where it ends
+		if (next != m_freeRanges.end() && offset + size == next->first) {
+			size += next->second;
+			RemoveFreeRange(next);
+		}
+
+		AddFreeRange(offset, size);
+	}
+
+	void RangeAllocator::Carve(const uint32_t rangeOffset, const uint32_t offset, const uint32_t size) {
+		auto range = m_freeRanges.find(rangeOffset);
+		assert(range != m_freeRanges.end() && offset >= rangeOffset && offset + size <= rangeOffset + range->second);
+
+		const uint32_t rangeEnd = rangeOffset + range->second;
+		RemoveFreeRange(range);
+
+		// alignment padding in front and whatever is left behind stay free
+		if (offset > rangeOffset) {
+			AddFreeRange(rangeOffset, offset - rangeOffset);
+		}
+		if (offset + size < rangeEnd) {
+			AddFreeRange(offset + size, rangeEnd - offset - size);
+		}
+	}
+}
\ No newline at end of file
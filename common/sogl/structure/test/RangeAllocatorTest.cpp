@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <sogl/structure/RangeAllocator.h>
+#include <sogl/test/Test.h>
+
+using namespace sogl;
+
+// Stands in for the buffer behind an allocator: the id of whoever wrote each unit, and how many live ranges
+// claim it, which is 2 where a slid copy overlaps its waiting source.
+struct Space {
+	std::vector<int> data;
+	std::vector<uint8_t> claims;
+	// offset -> id
+	std::map<uint32_t, int> live;
+
+	explicit Space(const uint32_t capacity) : data(capacity, -1), claims(capacity, 0), live() {}
+
+	void Claim(const uint32_t offset, const uint32_t size, const int id) {
+		for (uint32_t i = offset; i < offset + size; i++) {
+			data[i] = id;
+			claims[i]++;
+		}
+	}
+
+	void Release(const uint32_t offset, const uint32_t size) {
+		for (uint32_t i = offset; i < offset + size; i++) {
+			claims[i]--;
+		}
+	}
+
+	bool IsFree(const uint32_t offset, const uint32_t size) const {
+		for (uint32_t i = offset; i < offset + size; i++) {
+			if (claims[i] != 0)
+				return false;
+		}
+		return true;
+	}
+
+	uint32_t ClaimedSize() const {
+		return static_cast<uint32_t>(claims.size() - std::count(claims.begin(), claims.end(), 0));
+	}
+};
+
+// Fills a space with ranges of 1 to maxSize units, then frees random ones until no more than occupancy of it is
+// used.
+static void Fragment(RangeAllocator& allocator, Space& space, std::mt19937& random, const uint32_t maxSize, const float occupancy) {
+	int id = 0;
+	while (true) {
+		const uint32_t size = 1 + random() % maxSize;
+		const uint32_t offset = allocator.Allocate(size);
+		if (offset == RangeAllocator::INVALID_OFFSET)
+			break;
+
+		space.Claim(offset, size, id);
+		space.live[offset] = id++;
+	}
+
+	while (allocator.UsedSize() > occupancy * allocator.Capacity()) {
+		auto it = space.live.begin();
+		std::advance(it, random() % space.live.size());
+		space.Release(it->first, allocator.SizeOf(it->first));
+		allocator.Free(it->first);
+		space.live.erase(it);
+	}
+}
+
+// Applies moves like ChunkArena does, freeing each source two steps later. Returns false if a move was bad.
+static bool ApplyMoves(RangeAllocator& allocator, Space& space, const std::vector<RangeAllocator::Move>& moves, std::vector<uint32_t>& outSources) {
+	for (const RangeAllocator::Move& move : moves) {
+		auto source = space.live.find(move.from);
+		if (source == space.live.end() || allocator.SizeOf(move.from) != move.size)
+			return false;
+
+		// only a slide down may overlap, and only over the source itself
+		const bool overlaps = move.to < move.from + move.size && move.from < move.to + move.size;
+		if (overlaps && move.to >= move.from)
+			return false;
+		if (!space.IsFree(move.to, (overlaps ? move.from : move.to + move.size) - move.to))
+			return false;
+
+		// memmove, the source is still claimed until it's freed
+		const std::vector<int> copy(space.data.begin() + move.from, space.data.begin() + move.from + move.size);
+		const int id = source->second;
+		space.Claim(move.to, move.size, id);
+		std::copy(copy.begin(), copy.end(), space.data.begin() + move.to);
+		space.live.erase(source);
+		space.live[move.to] = id;
+		outSources.push_back(move.from);
+	}
+
+	return true;
+}
+
+static bool Intact(const RangeAllocator& allocator, const Space& space) {
+	uint32_t end = 0;
+	for (const auto& range : space.live) {
+		const uint32_t size = allocator.SizeOf(range.first);
+		if (size == 0 || range.first < end)
+			return false;
+
+		for (uint32_t i = range.first; i < range.first + size; i++) {
+			if (space.data[i] != range.second)
+				return false;
+		}
+		end = range.first + size;
+	}
+
+	return space.ClaimedSize() == allocator.UsedSize();
+}
+
+SOGL_TEST(RangeAllocator_AllocateFreeResize) {
+	std::mt19937 random(25);
+	const uint32_t capacity = 1 << 14;
+	RangeAllocator allocator(capacity);
+	Space space(capacity);
+	int id = 0;
+
+	bool valid = true;
+	for (uint32_t i = 0; i < 20000; i++) {
+		const uint32_t action = random() % 10;
+		if (action < 5 || space.live.empty()) {
+			const uint32_t alignment = 1u << (random() % 5);
+			const uint32_t size = 1 + random() % 200;
+			const uint32_t offset = allocator.Allocate(size, alignment);
+			if (offset == RangeAllocator::INVALID_OFFSET)
+				continue;
+
+			valid = valid && offset % alignment == 0 && offset + size <= capacity && space.IsFree(offset, size);
+			space.Claim(offset, size, id);
+			space.live[offset] = id++;
+			continue;
+		}
+
+		auto range = space.live.begin();
+		std::advance(range, random() % space.live.size());
+		const uint32_t size = allocator.SizeOf(range->first);
+		if (action < 8) {
+			space.Release(range->first, size);
+			allocator.Free(range->first);
+			space.live.erase(range);
+			continue;
+		}
+
+		const uint32_t newSize = 1 + random() % 300;
+		const bool room = newSize <= size || (range->first + newSize <= capacity && space.IsFree(range->first + size, newSize - size));
+		valid = valid && allocator.Resize(range->first, newSize) == room;
+		if (room) {
+			space.Release(range->first, size);
+			space.Claim(range->first, newSize, range->second);
+		}
+	}
+
+	SOGL_CHECK(valid);
+	SOGL_CHECK(Intact(allocator, space));
+	SOGL_CHECK(allocator.Allocate(0) == RangeAllocator::INVALID_OFFSET);
+	SOGL_CHECK(!allocator.Resize(space.live.begin()->first, 0));
+
+	// everything freed merges back into one range
+	for (const auto& range : space.live) {
+		allocator.Free(range.first);
+	}
+	SOGL_CHECK(allocator.UsedSize() == 0 && allocator.FreeRangeCount() == 1 && allocator.LargestFreeRange() == capacity);
+}
+
+SOGL_TEST(RangeAllocator_CompactReachesSingleRange) {
+	const uint32_t capacity = 1 << 13;
+	uint32_t converged = 0;
+	bool valid = true;
+
+	// mostly full spaces, where no range fits in any hole and compacting has to slide ranges over their own front
+	for (uint32_t seed = 0; seed < 200; seed++) {
+		std::mt19937 random(seed);
+		RangeAllocator allocator(capacity);
+		Space space(capacity);
+		Fragment(allocator, space, random, 150, 0.93f);
+
+		std::vector<RangeAllocator::Move> moves;
+		std::vector<uint32_t> waiting[2];
+		for (uint32_t step = 0; step < 1000; step++) {
+			// sources from two steps ago are done with
+			for (const uint32_t source : waiting[step & 1]) {
+				space.Release(source, allocator.SizeOf(source));
+				allocator.Free(source);
+			}
+			waiting[step & 1].clear();
+
+			moves.clear();
+			const uint32_t moved = allocator.Compact(1024, moves);
+			valid = valid && ApplyMoves(allocator, space, moves, waiting[step & 1]);
+			if (moved == 0 && waiting[0].empty() && waiting[1].empty())
+				break;
+		}
+
+		valid = valid && Intact(allocator, space);
+		// the one free range is at the top
+		const uint32_t freeSize = capacity - allocator.UsedSize();
+		converged += allocator.FreeRangeCount() == 1 && allocator.LargestFreeRange() == freeSize && space.IsFree(capacity - freeSize, freeSize);
+	}
+
+	SOGL_CHECK(valid);
+	SOGL_CHECK(converged == 200);
+}
+
+SOGL_TEST(RangeAllocator_CompactWaitsForChanges) {
+	std::vector<RangeAllocator::Move> moves;
+	{
+		// pinned ranges stay where they are, and the hole below one waits until it's freed
+		RangeAllocator allocator(10);
+		const uint32_t first = allocator.Allocate(2);
+		const uint32_t pinned = allocator.Allocate(4);
+		allocator.Allocate(4);
+		allocator.Free(first);
+		allocator.Pin(pinned);
+		SOGL_CHECK(allocator.Compact(100, moves) == 0 && moves.empty());
+		SOGL_CHECK(!allocator.Resize(pinned, 3));
+		allocator.Free(pinned);
+		SOGL_CHECK(allocator.Compact(100, moves) == 4 && moves.size() == 1);
+	}
+
+	moves.clear();
+	RangeAllocator allocator(10);
+	const uint32_t a = allocator.Allocate(2);
+	const uint32_t b = allocator.Allocate(4);
+	const uint32_t c = allocator.Allocate(4);
+	allocator.Free(a);
+
+	// nothing fits the 2 unit hole, and there's no room above, so b slides down over its own front
+	SOGL_CHECK(allocator.Compact(100, moves) == 4 && moves.size() == 1);
+	SOGL_CHECK(moves[0].from == b && moves[0].to == 0 && moves[0].size == 4);
+	SOGL_CHECK(allocator.UsedSize() == 10);
+
+	// full until the source is freed, and Compact doesn't keep looking until then
+	moves.clear();
+	SOGL_CHECK(allocator.Compact(100, moves) == 0 && moves.empty());
+	SOGL_CHECK(allocator.Compact(100, moves) == 0 && moves.empty());
+
+	// freeing the source only releases what the copy didn't take over
+	allocator.Free(b);
+	SOGL_CHECK(allocator.UsedSize() == 8 && allocator.FreeRangeCount() == 1 && allocator.LargestFreeRange() == 2);
+	moves.clear();
+	SOGL_CHECK(allocator.Compact(100, moves) == 4 && moves.size() == 1);
+	SOGL_CHECK(moves[0].from == c && moves[0].to == 4);
+	allocator.Free(c);
+	SOGL_CHECK(allocator.FreeRangeCount() == 1 && allocator.Allocate(2) == 8);
+}
+
+SOGL_BENCHMARK(RangeAllocator_Compact) {
+	// about a chunk arena's worth of meshes, in vertices
+	const uint32_t capacity = 1 << 22;
+	const float occupancies[] = { 0.5f, 0.8f, 0.93f };
+	for (const float occupancy : occupancies) {
+		std::mt19937 random(7);
+		RangeAllocator allocator(capacity);
+		Space space(capacity);
+		Fragment(allocator, space, random, 8000, occupancy);
+		const uint32_t ranges = allocator.FreeRangeCount();
+
+		std::vector<RangeAllocator::Move> moves;
+		std::vector<uint32_t> waiting[2];
+		uint32_t steps = 0;
+		uint64_t moved = 0;
+		double slowest = 0.0;
+		for (; steps < 10000; steps++) {
+			for (const uint32_t source : waiting[steps & 1]) {
+				space.Release(source, allocator.SizeOf(source));
+				allocator.Free(source);
+			}
+			waiting[steps & 1].clear();
+
+			moves.clear();
+			uint32_t stepMoved = 0;
+			slowest = std::max(slowest, test::BestOf(1, [&]() { stepMoved = allocator.Compact(64 * 1024, moves); }));
+			ApplyMoves(allocator, space, moves, waiting[steps & 1]);
+			moved += stepMoved;
+			if (stepMoved == 0 && waiting[0].empty() && waiting[1].empty())
+				break;
+		}
+
+		printf("  %2.0f%% used, %5u free ranges: %4u steps to 1 range (%u), %6.1f MB moved, slowest Compact %.0f us\n",
+			100.0f * allocator.UsedSize() / capacity, ranges, steps, allocator.FreeRangeCount(), moved * 4.0 / (1 << 20), slowest);
+	}
+}
\ No newline at end of file
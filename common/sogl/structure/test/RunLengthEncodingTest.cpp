@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+#include <sogl/structure/runLengthEncoding.h>
+#include <sogl/test/Fixtures.h>
+#include <sogl/test/Test.h>
+
+using namespace sogl;
+
+template<typename T>
+static bool RoundTrips(const std::vector<T>& values) {
+	const runLengthEncoding<T> runs(values.data(), static_cast<uint32_t>(values.size()));
+
+	uint32_t runCount = values.empty() ? 0 : 1;
+	for (size_t i = 1; i < values.size(); i++) {
+		runCount += values[i] != values[i - 1];
+	}
+
+	std::vector<T> decoded(values.size());
+	return runs.decode(decoded.data(), static_cast<uint32_t>(decoded.size())) && decoded == values && runs.runCount() == runCount;
+}
+
+SOGL_TEST(RunLengthEncoding_RoundTrip) {
+	std::mt19937 random(12);
+	bool same = true;
+	// every length around the 16 byte blocks the SSE2 path compares, with short and long runs
+	for (uint32_t count = 0; count < 200; count++) {
+		for (uint32_t types = 1; types < 5; types++) {
+			std::vector<uint8_t> bytes(count);
+			std::vector<uint16_t> words(count);
+			for (uint32_t i = 0; i < count; i++) {
+				bytes[i] = static_cast<uint8_t>(random() % types);
+				words[i] = static_cast<uint16_t>(random() % types * 300);
+			}
+			same = same && RoundTrips(bytes) && RoundTrips(words);
+		}
+	}
+	SOGL_CHECK(same);
+
+	// runs longer than a single varint byte holds
+	std::vector<uint8_t> uniform(300000, 7);
+	SOGL_CHECK(RoundTrips(uniform));
+	uniform[150000] = 1;
+	SOGL_CHECK(RoundTrips(uniform));
+	SOGL_CHECK(RoundTrips(test::TerrainVoxels()));
+}
+
+SOGL_TEST(RunLengthEncoding_RejectsMalformedData) {
+	uint8_t decoded[10];
+	runLengthEncoding<uint8_t> runs;
+
+	// a varint that never ends
+	const uint8_t endless[] = { 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+	runs.assign(endless, sizeof(endless), 10);
+	SOGL_CHECK(!runs.decode(decoded, 10));
+
+	// runs adding up to more, and to fewer, values than expected
+	const uint8_t tooLong[] = { 1, 6, 2, 6 };
+	runs.assign(tooLong, sizeof(tooLong), 10);
+	SOGL_CHECK(!runs.decode(decoded, 10));
+	const uint8_t tooShort[] = { 1, 3, 2, 3 };
+	runs.assign(tooShort, sizeof(tooShort), 10);
+	SOGL_CHECK(!runs.decode(decoded, 10));
+
+	// a value cut off halfway
+	const uint8_t truncated[] = { 1, 10, 2 };
+	runs.assign(truncated, sizeof(truncated), 10);
+	SOGL_CHECK(!runs.decode(decoded, 10));
+
+	const uint8_t valid[] = { 1, 4, 2, 6 };
+	runs.assign(valid, sizeof(valid), 10);
+	SOGL_CHECK(runs.decode(decoded, 10) && decoded[3] == 1 && decoded[4] == 2);
+}
+
+SOGL_BENCHMARK(RunLengthEncoding_Chunks) {
+	std::mt19937 random(13);
+	std::vector<uint8_t> noise(ChunkSummary::VOXELS);
+	for (uint8_t& voxel : noise) {
+		voxel = random() % 3 == 0 ? static_cast<uint8_t>(1 + random() % 4) : 0;
+	}
+
+	const std::vector<uint8_t> chunks[] = { std::vector<uint8_t>(ChunkSummary::VOXELS, 0), test::TerrainVoxels(), noise };
+	const char* names[] = { "uniform", "terrain", "noise" };
+	std::vector<uint8_t> decoded(ChunkSummary::VOXELS);
+	for (uint32_t i = 0; i < 3; i++) {
+		runLengthEncoding<uint8_t> runs;
+		const double encode = test::BestOf(50, [&]() { runs.encode(chunks[i].data(), ChunkSummary::VOXELS); });
+		const double decode = test::BestOf(50, [&]() {
+			runs.decode(decoded.data(), ChunkSummary::VOXELS);
+			test::DoNotOptimize(decoded.data());
+		});
+		printf("  %-8s %7u runs, %7zu B, encode %7.1f us, decode %7.1f us\n", names[i], runs.runCount(), runs.data().size(), encode, decode);
+	}
+}
\ No newline at end of file
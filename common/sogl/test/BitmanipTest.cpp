@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <bitset>
+#include <random>
+#include <vector>
+
+#include <sogl/bitmanip.hpp>
+#include <sogl/test/Test.h>
+
+using namespace sogl;
+
+// the bit by bit loops the intrinsics replaced, used as the reference and the baseline
+static uint64_t LoopTrailingZeroes(const uint64_t value) {
+	const std::bitset<64> bits(value);
+	uint64_t count = 0;
+	while (count < 64 && !bits[count]) {
+		count++;
+	}
+	return count;
+}
+
+static uint64_t LoopTrailingOnes(const uint64_t value) {
+	const std::bitset<64> bits(value);
+	uint64_t count = 0;
+	while (count < 64 && bits[count]) {
+		count++;
+	}
+	return count;
+}
+
+// random words with every run length, plus the 0 and ~0 edge cases
+static std::vector<uint64_t> TestWords(const uint32_t count) {
+	std::mt19937_64 random(4);
+	std::vector<uint64_t> words(count);
+	for (uint32_t i = 0; i < count; i++) {
+		const uint32_t shift = random() % 64;
+		words[i] = i % 7 == 0 ? 0 : (i % 11 == 0 ? ~0ull << shift : random() >> shift);
+	}
+	words[1] = ~0ull;
+	return words;
+}
+
+SOGL_TEST(Bitmanip_MatchesBitLoops) {
+	bool same = true;
+	for (const uint64_t word : TestWords(100000)) {
+		same = same && trailing_zeroes(word) == LoopTrailingZeroes(word);
+		same = same && trailing_ones(word) == LoopTrailingOnes(word);
+		same = same && popcount(word) == std::bitset<64>(word).count();
+	}
+	SOGL_CHECK(same);
+
+	SOGL_CHECK(trailing_zeroes(0) == 64);
+	SOGL_CHECK(trailing_ones(~0ull) == 64);
+	SOGL_CHECK(trailing_zeroes(1ull << 63) == 63);
+}
+
+SOGL_TEST(Bitmanip_Transpose) {
+	const std::vector<uint64_t> words = TestWords(64);
+	std::vector<uint64_t> rows = words;
+	transpose_64x64(rows.data());
+
+	bool same = true;
+	for (uint32_t i = 0; i < 64; i++) {
+		for (uint32_t j = 0; j < 64; j++) {
+			same = same && ((rows[j] >> i) & 1) == ((words[i] >> j) & 1);
+		}
+	}
+	SOGL_CHECK(same);
+
+	// twice gives the original back
+	transpose_64x64(rows.data());
+	SOGL_CHECK(rows == words);
+}
+
+SOGL_BENCHMARK(Bitmanip_AgainstBitLoops) {
+	const std::vector<uint64_t> words = TestWords(1 << 16);
+	uint64_t sum = 0;
+
+	auto time = [&](uint64_t(*function)(const uint64_t)) {
+		return test::BestOf(20, [&]() {
+			for (const uint64_t word : words) {
+				sum += function(word);
+			}
+			test::DoNotOptimize(&sum);
+		}) * 1000.0 / words.size();
+	};
+
+	printf("  trailing_zeroes %6.2f ns, bit loop %6.2f ns\n", time(trailing_zeroes), time(LoopTrailingZeroes));
+	printf("  trailing_ones   %6.2f ns, bit loop %6.2f ns\n", time(trailing_ones), time(LoopTrailingOnes));
+	printf("  popcount        %6.2f ns\n", time(popcount));
+
+	std::vector<uint64_t> rows = words;
+	const double transpose = test::BestOf(200, [&]() {
+		transpose_64x64(rows.data());
+		test::DoNotOptimize(rows.data());
+	});
+	printf("  transpose_64x64 %6.2f us\n", transpose);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <sogl/world/data/chunk.h>
+
+namespace sogl {
+	namespace test {
+		// A chunk's worth of voxel types, x fastest, then y, then z: stone under dirt under air, with a bumpy surface,
+		// roughly what the terrain generator produces.
+		inline std::vector<uint8_t> TerrainVoxels() {
+			std::vector<uint8_t> voxels(ChunkSummary::VOXELS);
+			for (uint32_t z = 0; z < 64; z++) {
+				for (uint32_t y = 0; y < 64; y++) {
+					for (uint32_t x = 0; x < 64; x++) {
+						const uint32_t surface = 20 + (x / 8 + z / 8) % 5;
+						voxels[z * 4096 + y * 64 + x] = y < surface ? (y < 15 ? STONE : DIRT) : AIR;
+					}
+				}
+			}
+
+			return voxels;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+
+namespace sogl {
+	namespace test {
+		typedef void(*TestFunction)();
+
+		struct TestCase {
+			const char* name;
+			TestFunction function;
+			// only run with --bench
+			bool benchmark;
+			TestCase* next;
+		};
+
+		// Adds a test case to the list the runner goes through. Used by SOGL_TEST and SOGL_BENCHMARK.
+		struct Registrar {
+			Registrar(TestCase& testCase);
+		};
+
+		TestCase* FirstTestCase();
+
+		// Records a failed check in the test case being run.
+		void Fail(const char* expression, const char* file, const int line);
+		uint32_t FailureCount();
+
+		// Last value passed to DoNotOptimize. Visible to other files, so the compiler can't drop the stores to it.
+		extern const void* volatile Sink;
+
+		// Keeps the compiler from throwing away a result a benchmark never reads.
+		void DoNotOptimize(const void* value);
+
+		// Fastest of runs calls to function, in microseconds.
+		template<typename F>
+		double BestOf(const uint32_t runs, F function) {
+			double best = 1e30;
+			for (uint32_t i = 0; i < runs; i++) {
+				const auto start = std::chrono::steady_clock::now();
+				function();
+				const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+				if (us < best)
+					best = us;
+			}
+
+			return best;
+		}
+	}
+}
+
+#define SOGL_TEST_CASE(name, benchmark) \
+	static void name(); \
+	static sogl::test::TestCase name##_case = { #name, &name, benchmark, nullptr }; \
+	static sogl::test::Registrar name##_registrar(name##_case); \
+	static void name()
+
+// Defines a test, run every time the test runner starts.
+#define SOGL_TEST(name) SOGL_TEST_CASE(name, false)
+// Defines a benchmark, only run when the test runner is started with --bench.
+#define SOGL_BENCHMARK(name) SOGL_TEST_CASE(name, true)
+
+// Fails the current test if expression is false, and keeps going.
+#define SOGL_CHECK(expression) \
+	do { if (!(expression)) sogl::test::Fail(#expression, __FILE__, __LINE__); } while (0)
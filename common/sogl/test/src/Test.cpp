@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <sogl/test/Test.h>
+
+namespace sogl {
+	namespace test {
+		// registrars run in whatever order the linker puts the files in, so keep a plain list and no static objects
+		static TestCase* s_first = nullptr;
+		static TestCase* s_last = nullptr;
+		static uint32_t s_failures = 0;
+
+		const void* volatile Sink = nullptr;
+
+		Registrar::Registrar(TestCase& testCase) {
+			if (s_last != nullptr) {
+				s_last->next = &testCase;
+			}
+			else {
+				s_first = &testCase;
+			}
+			s_last = &testCase;
+		}
+
+		TestCase* FirstTestCase() {
+			return s_first;
+		}
+
+		void Fail(const char* expression, const char* file, const int line) {
+			// only the file name, the full path is mostly noise
+			const char* name = file;
+			for (const char* c = file; *c != '\0'; c++) {
+				if (*c == '/' || *c == '\\')
+					name = c + 1;
+			}
+
+			printf("    %s:%d: %s\n", name, line, expression);
+			s_failures++;
+		}
+
+		uint32_t FailureCount() {
+			return s_failures;
+		}
+
+		void DoNotOptimize(const void* value) {
+			Sink = value;
+		}
+	}
+}
+
+// sogl_tests [--bench] [name filter]
+int main(int argc, char** argv) {
+	using namespace sogl::test;
+
+	bool benchmarks = false;
+	const char* filter = nullptr;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--bench") == 0) {
+			benchmarks = true;
+		}
+		else {
+			filter = argv[i];
+		}
+	}
+
+	uint32_t run = 0;
+	uint32_t failed = 0;
+	for (TestCase* testCase = FirstTestCase(); testCase != nullptr; testCase = testCase->next) {
+		if (testCase->benchmark != benchmarks || (filter != nullptr && strstr(testCase->name, filter) == nullptr))
+			continue;
+
+		printf("%s\n", testCase->name);
+		const uint32_t failures = FailureCount();
+		testCase->function();
+		run++;
+
+		if (FailureCount() != failures) {
+			printf("  FAILED\n");
+			failed++;
+		}
+	}
+
+	printf("%u of %u %s passed\n", run - failed, run, benchmarks ? "benchmarks" : "tests");
+	return failed == 0 ? 0 : 1;
+}
\ No newline at end of file
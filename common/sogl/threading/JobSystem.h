@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sogl {
+	struct Job;
+	// Work executed on a worker thread. The job is passed in so long-running work can poll for cancellation.
+	typedef std::function<void(const Job& job)> JobFunc;
+	// Completion callback executed on the thread that calls JobSystem::ProcessCompleted().
+	typedef std::function<void()> JobCallback;
+
+	struct Job {
+	private:
+		friend class JobSystem;
+
+		JobFunc m_work;
+		JobCallback m_onComplete;
+		float m_priority;
+		uint64_t m_tag;
+		uint64_t m_sequence;
+
+		std::atomic<bool> m_cancelled;
+		std::atomic<bool> m_finished;
+	public:
+		Job(JobFunc work, JobCallback onComplete, const float priority, const uint64_t tag);
+		Job(const Job&) = delete;
+
+		// Requests cancellation. A job that has not started will be skipped, and the completion callback
+		// of a cancelled job is never invoked. Long-running work can poll IsCancelled() to bail out early.
+		inline void Cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+		inline bool IsCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+		inline bool IsFinished() const { return m_finished.load(std::memory_order_acquire); }
+		inline uint64_t Tag() const { return m_tag; }
+	};
+
+	typedef std::shared_ptr<Job> JobHandle;
+
+	/// <summary>
+	/// <para>Fixed pool of worker threads fed from a priority queue (lowest priority value runs first).</para>
+	/// <para>Work runs on a worker thread; the completion callback runs on whichever thread calls
+	/// ProcessCompleted(), which should be the GL thread so results can be uploaded there.</para>
+	/// </summary>
+	class JobSystem {
+		std::vector<std::thread> m_workers;
+		// binary min-heap ordered by (priority, sequence)
+		std::vector<JobHandle> m_queue;
+		std::deque<JobHandle> m_completed;
+
+		std::mutex m_queueLock;
+		std::mutex m_completedLock;
+		std::condition_variable m_queueSignal;
+
+		uint64_t m_nextSequence;
+		std::atomic<uint32_t> m_activeCount;
+		bool m_running;
+
+		static bool RunsBefore(const JobHandle& a, const JobHandle& b);
+		void WorkerLoop();
+	public:
+		// A worker count of 0 uses one thread per hardware core, minus one for the main thread.
+		JobSystem(uint32_t workerCount = 0);
+		JobSystem(const JobSystem&) = delete;
+		~JobSystem();
+
+		JobHandle Schedule(JobFunc work, JobCallback onComplete = nullptr, const float priority = 0.0f, const uint64_t tag = 0);
+
+		// Re-evaluates the priority of every queued job, e.g. after the camera moved.
+		void Reprioritize(const std::function<float(uint64_t tag)>& priorityFunc);
+
+		// Runs completion callbacks for up to maxCount finished jobs. Returns the number processed.
+		uint32_t ProcessCompleted(const uint32_t maxCount = UINT32_MAX);
+
+		// Cancels every queued job, blocks until the workers are idle and drops all pending results.
+		void CancelAll();
+
+		uint32_t QueuedCount();
+		inline uint32_t WorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+	};
+}
\ No newline at end of file
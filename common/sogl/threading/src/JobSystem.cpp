@@ -0,0 +1,147 @@
+#include <algorithm>
+
+#include <sogl/threading/JobSystem.h>
+
+namespace sogl {
+	Job::Job(JobFunc work, JobCallback onComplete, const float priority, const uint64_t tag)
+		: m_work(work), m_onComplete(onComplete), m_priority(priority), m_tag(tag), m_sequence(0), m_cancelled(false), m_finished(false) {}
+
+	JobSystem::JobSystem(uint32_t workerCount) : m_nextSequence(0), m_activeCount(0), m_running(true) {
+		if (workerCount == 0) {
+			uint32_t cores = std::thread::hardware_concurrency();
+			workerCount = cores > 1 ? cores - 1 : 1;
+		}
+
+		m_workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; i++) {
+			m_workers.emplace_back(&JobSystem::WorkerLoop, this);
+		}
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(m_queueLock);
+			m_running = false;
+			for (JobHandle& job : m_queue) {
+				job->Cancel();
+			}
+		}
+		m_queueSignal.notify_all();
+
+		for (std::thread& worker : m_workers) {
+			worker.join();
+		}
+
+		// release anything left over on the owning thread
+		m_queue.clear();
+		m_completed.clear();
+	}
+
+	bool JobSystem::RunsBefore(const JobHandle& a, const JobHandle& b) {
+		if (a->m_priority != b->m_priority)
+			return a->m_priority < b->m_priority;
+
+		return a->m_sequence < b->m_sequence;
+	}
+
+	JobHandle JobSystem::Schedule(JobFunc work, JobCallback onComplete, const float priority, const uint64_t tag) {
+		JobHandle job = std::make_shared<Job>(work, onComplete, priority, tag);
+		{
+			std::lock_guard<std::mutex> lock(m_queueLock);
+			job->m_sequence = m_nextSequence++;
+			m_queue.push_back(job);
+			// std heaps are max-heaps, so invert the comparison to pop the lowest priority first
+			std::push_heap(m_queue.begin(), m_queue.end(), [](const JobHandle& a, const JobHandle& b) { return RunsBefore(b, a); });
+		}
+		m_queueSignal.notify_one();
+
+		return job;
+	}
+
+	void JobSystem::Reprioritize(const std::function<float(uint64_t tag)>& priorityFunc) {
+		std::lock_guard<std::mutex> lock(m_queueLock);
+		for (JobHandle& job : m_queue) {
+			job->m_priority = priorityFunc(job->m_tag);
+		}
+
+		std::make_heap(m_queue.begin(), m_queue.end(), [](const JobHandle& a, const JobHandle& b) { return RunsBefore(b, a); });
+	}
+
+	uint32_t JobSystem::ProcessCompleted(const uint32_t maxCount) {
+		uint32_t processed = 0;
+		while (processed < maxCount) {
+			JobHandle job;
+			{
+				std::lock_guard<std::mutex> lock(m_completedLock);
+				if (m_completed.empty())
+					break;
+
+				job = m_completed.front();
+				m_completed.pop_front();
+			}
+
+			// cancelled jobs are still routed through here so that their captured results are freed on this thread
+			if (!job->IsCancelled() && job->m_onComplete) {
+				job->m_onComplete();
+				processed++;
+			}
+
+			job->m_work = nullptr;
+			job->m_onComplete = nullptr;
+		}
+
+		return processed;
+	}
+
+	void JobSystem::CancelAll() {
+		{
+			std::lock_guard<std::mutex> lock(m_queueLock);
+			for (JobHandle& job : m_queue) {
+				job->Cancel();
+			}
+		}
+
+		// wait for queued and in-flight work to drain into the completed list, then drop everything
+		while (QueuedCount() > 0 || m_activeCount.load() > 0) {
+			std::this_thread::yield();
+		}
+
+		std::lock_guard<std::mutex> lock(m_completedLock);
+		m_completed.clear();
+	}
+
+	uint32_t JobSystem::QueuedCount() {
+		std::lock_guard<std::mutex> lock(m_queueLock);
+		return static_cast<uint32_t>(m_queue.size());
+	}
+
+	void JobSystem::WorkerLoop() {
+		while (true) {
+			JobHandle job;
+			{
+				std::unique_lock<std::mutex> lock(m_queueLock);
+				m_queueSignal.wait(lock, [this]() { return !m_running || !m_queue.empty(); });
+
+				if (!m_running)
+					return;
+
+				std::pop_heap(m_queue.begin(), m_queue.end(), [](const JobHandle& a, const JobHandle& b) { return RunsBefore(b, a); });
+				job = m_queue.back();
+				m_queue.pop_back();
+				m_activeCount++;
+			}
+
+			if (!job->IsCancelled()) {
+				job->m_work(*job);
+			}
+
+			job->m_finished.store(true, std::memory_order_release);
+
+			{
+				std::lock_guard<std::mutex> lock(m_completedLock);
+				m_completed.push_back(job);
+			}
+			m_activeCount--;
+		}
+	}
+}
\ No newline at end of file
@@ -28,8 +28,10 @@ namespace sogl {
 			*this = v;
 		}
 
-		inline vec3i operator=(const vec3i& v) {
+		inline vec3i& operator=(const vec3i& v) {
 			set(v.x, v.y, v.z);
+
+			return *this;
 		}
 
 		inline void set(int32_t x, int32_t y, int32_t z) {
@@ -74,6 +76,23 @@ namespace sogl {
 			return c;
 		}
 
+		inline vec3i operator+(const vec3i& v) const {
+			vec3i v1(*this);
+			v1.x += v.x;
+			v1.y += v.y;
+			v1.z += v.z;
+
+			return v1;
+		}
+
+		inline vec3i& operator+=(const vec3i& v) {
+			x += v.x;
+			y += v.y;
+			z += v.z;
+
+			return *this;
+		}
+
 		inline vec3i operator-(const vec3i& v) const {
 			vec3i v1(*this);
 			v1.x -= v.x;
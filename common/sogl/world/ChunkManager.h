@@ -0,0 +1,258 @@
+#pragma once
+
+#include <stdint.h>
+#include <list>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include <sogl/transform/vec3f.hpp>
+#include <sogl/transform/vec3i.hpp>
+#include <sogl/structure/runLengthEncoding.h>
+#include <sogl/rendering/Frustum.h>
+#include <sogl/threading/JobSystem.h>
+#include <sogl/world/data/chunkMesh.h>
+#include <sogl/world/generation/TerrainGenerator.h>
+
+namespace sogl {
+	struct Chunk;
+	class RegionStore;
+	enum voxelType : uint8_t;
+
+	struct ChunkManagerSettings {
+		// Horizontal distance (in chunks) from the camera's chunk that is kept loaded.
+		int32_t viewRadius = 2;
+		// Vertical distance (in chunks) from the camera's chunk that is kept loaded.
+		int32_t verticalRadius = 1;
+		// Hard cap on the CPU memory held by resident chunks and their meshes, in bytes.
+		uint64_t memoryBudget = 512ull * 1024 * 1024;
+		// Distance (in chunks) beyond the view radius within which chunks that left view keep their voxels
+		// compressed in memory, so coming back to them skips disk and generation. Should be at least 1.
+		int32_t keepAliveDistance = 3;
+		// Cap on the memory held by those compressed chunks. The least recently evicted go to disk first.
+		uint64_t keepAliveBudget = 64ull * 1024 * 1024;
+		// Number of finished chunks that may be uploaded to the GPU during a single update.
+		uint32_t uploadsPerUpdate = 2;
+		// Maximum number of chunks being generated/meshed on worker threads at once.
+		uint32_t maxPendingJobs = 16;
+		// Number of worker threads used for generation and meshing (0 = one per core, minus the main thread).
+		uint32_t workerThreads = 0;
+		// Directory for region files. Chunks are read from it before falling back to generation and written back
+		// when they go cold. nullptr keeps the world in memory only.
+		const char* saveDirectory = nullptr;
+		// Use region files saved with a different world seed or terrain settings anyway, instead of leaving those
+		// regions to generation and never saving them. Their chunks won't line up with newly generated ones, and
+		// new chunks saved into them mix the two worlds for good. Read when the save directory is opened.
+		bool openOtherWorldSaves = false;
+		// Distance (in chunks) from the camera's chunk beyond which chunks are meshed at half resolution. Every doubling
+		// of the distance halves it again, down to an eighth. 0 meshes every chunk at full detail.
+		int32_t lodDistance = 4;
+		// Skip chunks that can't be seen through the caves and open faces of the chunks between them and the camera.
+		bool occlusionCulling = true;
+		// How new chunks are generated. Only read when the manager is constructed, since saved chunks were
+		// generated with it.
+		TerrainSettings terrain;
+	};
+
+	enum class ChunkResidency {
+		// voxels decompressed, meshed and drawn
+		hot,
+		// run-length encoded voxels only, no mesh
+		warm,
+		// on disk, or not generated yet
+		cold
+	};
+
+	struct ChunkRenderStats {
+		uint32_t drawnChunks = 0;
+		// chunks with a mesh that were outside the frustum or occluded
+		uint32_t culledChunks = 0;
+		uint64_t triangles = 0;
+		// GPU time spent in ChunkManager::Draw, read back from the previous frames' timer query
+		double gpuTimeMs = 0.0;
+	};
+
+	/// <summary>
+	/// <para>Keeps a ring of chunks and their meshes resident around the camera.</para>
+	/// <para>Chunks are generated and meshed nearest-first on worker threads as the camera moves, then uploaded
+	/// on the GL thread. Chunks that leave the view radius (or exceed the memory budget, farthest-first) are
+	/// evicted, and jobs for chunks that leave the radius before finishing are cancelled.</para>
+	/// <para>Chunks that leave view go warm: their voxels are run-length encoded on a worker thread and the
+	/// mesh is freed. Warm chunks further than the keep-alive distance, or beyond the keep-alive budget
+	/// (least recently evicted first), go cold: with a save directory they are written to region files, otherwise
+	/// they are dropped and regenerated later. Loads check the warm set, then the region files, then generate.</para>
+	/// <para>Empty chunks are never meshed or drawn, and chunks walled in by fully solid neighbour faces are not
+	/// drawn, going by each chunk's ChunkSummary. Beyond that, chunks are only drawn if a flood fill from the
+	/// camera's chunk reaches them through faces that the air of the chunks in between connects.</para>
+	/// <para>Meshes cull faces against the border slices of loaded neighbours. Whenever a neighbour loads or
+	/// unloads, the affected chunks are remeshed in the background from a snapshot of their voxels.
+	/// Single voxel edits are instead patched into the existing meshes on the spot.</para>
+	/// <para>Chunks past the LOD distance are meshed from downsampled voxels and remeshed when the camera moves enough
+	/// to change their level. Borders are always captured at full detail, and a coarse face is only culled where the
+	/// neighbour is solid across all of it, so neighbours of different levels overlap at their seams instead of
+	/// leaving cracks. Edits to a level-of-detail chunk remesh it in the background.</para>
+	/// </summary>
+	class ChunkManager {
+		struct ChunkEntry {
+			Chunk* chunk;
+			ChunkMesh* mesh;
+			vec3i coord;
+			uint64_t memoryUsage;
+			// neighbours (one bit per FaceDirection) that were loaded when the mesh's borders were captured
+			uint8_t meshedNeighbours;
+			// voxels differ from what is on disk (freshly generated or edited)
+			bool unsaved;
+			// all six neighbours are loaded and fully solid on the faces they share with this chunk, so it can't be
+			// seen unless the camera is inside it
+			bool enclosed;
+		};
+
+		// Output of a build or remesh job. Owns whatever the job produced until the manager takes it.
+		struct ChunkBuildResult {
+			Chunk* chunk = nullptr;
+			ChunkMesh* mesh = nullptr;
+			// captured on the main thread when the job is scheduled, so workers never touch other chunks
+			ChunkBorders borders;
+			uint8_t borderMask = 0;
+			uint8_t lod = 0;
+			// false when the voxels came from a region file unchanged
+			bool unsaved = true;
+			~ChunkBuildResult();
+		};
+
+		// A chunk reached by the occlusion flood fill.
+		struct OcclusionStep {
+			vec3i coord;
+			// FaceDirection the chunk was entered through, -1 for the camera's chunk
+			int8_t entryFace;
+			// directions moved in so far, one bit per FaceDirection
+			uint8_t travelled;
+		};
+
+		struct PendingRemesh {
+			JobHandle job;
+			uint8_t borderMask;
+			uint8_t lod;
+		};
+
+		// Compressed voxels of a chunk that left view. Shared so a load job can still read it if the entry is
+		// evicted in the meantime.
+		struct WarmChunk {
+			runLengthEncoding<uint8_t> voxels;
+			bool unsaved = false;
+			std::list<uint64_t>::iterator lruPosition;
+		};
+
+		// A chunk being compressed on a worker. The manager keeps ownership of the chunk until it is done.
+		struct PendingDemotion {
+			JobHandle job;
+			Chunk* chunk;
+			std::shared_ptr<WarmChunk> warm;
+			// the chunk's voxels, still counted in m_memoryUsage until it is deleted
+			uint64_t memoryUsage;
+		};
+
+		// set in the tags of demotion jobs, which chunk keys never use, so Reprioritize() can leave them be
+		static const uint64_t DEMOTION_TAG = 1ull << 63;
+
+		ChunkManagerSettings m_settings;
+		JobSystem m_jobs;
+		TerrainGenerator m_generator;
+		// nullptr without a save directory
+		RegionStore* m_regions;
+		std::unordered_map<uint64_t, ChunkEntry> m_loadedChunks;
+		std::unordered_map<uint64_t, JobHandle> m_pendingJobs;
+		std::unordered_map<uint64_t, PendingRemesh> m_pendingRemeshes;
+		std::unordered_map<uint64_t, PendingDemotion> m_pendingDemotions;
+		std::unordered_map<uint64_t, std::shared_ptr<WarmChunk>> m_warmChunks;
+		// most recently demoted first
+		std::list<uint64_t> m_warmLru;
+		uint64_t m_warmMemoryUsage;
+		// coordinates waiting to be loaded, sorted farthest-first so the nearest can be popped off the back
+		std::vector<vec3i> m_loadQueue;
+
+		vec3i m_centerChunk;
+		bool m_hasCenter;
+		uint64_t m_memoryUsage;
+		// part of m_memoryUsage held by chunks being demoted, which unloading more chunks won't free any sooner
+		uint64_t m_demotingMemoryUsage;
+
+		// reused by Draw() for the frustum test
+		std::vector<const ChunkEntry*> m_drawEntries;
+		AABBList m_drawBounds;
+		std::vector<uint8_t> m_drawVisible;
+		std::vector<OcclusionStep> m_occlusionQueue;
+		// chunks reached by the flood fill, indexed by OcclusionCell
+		std::vector<uint8_t> m_occlusionVisited;
+
+		ChunkRenderStats m_renderStats;
+		// double buffered GL_TIME_ELAPSED queries so reading a result never stalls on the current frame
+		uint32_t m_timerQueries[2];
+		uint32_t m_timerFrame;
+
+		static uint64_t PackCoord(const vec3i& coord);
+		static vec3i UnpackCoord(const uint64_t key);
+		bool InRange(const vec3i& coord, const int32_t padding) const;
+		int64_t DistanceSquared(const vec3i& coord) const;
+		// Level of detail a chunk at coord should be meshed with, going by its distance from the center.
+		uint32_t LodFor(const vec3i& coord) const;
+
+		void RebuildLoadQueue();
+		void EvictOutOfRange();
+		void EnforceMemoryBudget();
+		bool ScheduleChunk(const vec3i& coord);
+		void OnChunkBuilt(const vec3i& coord, ChunkBuildResult& result);
+		// Hot to warm, frees the mesh and compresses the voxels in the background.
+		void UnloadChunk(uint64_t key);
+		// Finishes the demotions whose compression is done. They aren't uploads, so they don't count against the cap.
+		void CollectDemotions();
+		void OnChunkDemoted(const vec3i& coord);
+		// Warm to cold, saving first unless discarded.
+		void RemoveWarmChunk(uint64_t key, const bool save);
+		void EnforceKeepAliveBudget();
+		void SaveChunk(const ChunkEntry& entry);
+
+		uint8_t LoadedNeighbourMask(const vec3i& coord) const;
+		bool IsEnclosed(const vec3i& coord) const;
+		// Index of coord in m_occlusionVisited, -1 if it is too far from the center to ever be loaded.
+		int32_t OcclusionCell(const vec3i& coord) const;
+		// Marks the chunks that may be visible from the camera's chunk through open faces and the frustum.
+		void FloodVisibleChunks(const Frustum* frustum);
+		uint8_t CaptureBorders(const vec3i& coord, ChunkBorders& outBorders) const;
+		// Remeshes the chunk at coord and its loaded neighbours if the set of neighbours they were meshed against changed,
+		// and updates whether they are enclosed.
+		void RefreshMeshes(const vec3i& coord);
+		// Remeshes the loaded chunks whose distance from the center now calls for another level of detail.
+		void RefreshLods();
+		void ScheduleRemesh(const vec3i& coord);
+		void OnChunkRemeshed(const vec3i& coord, ChunkBuildResult& result);
+	public:
+		ChunkManager(const ChunkManagerSettings& settings = ChunkManagerSettings());
+		ChunkManager(const ChunkManager&) = delete;
+		~ChunkManager();
+
+		// Streams chunks in and out around the given world-space position. Call once per frame on the GL thread.
+		void Update(const vec3f& cameraPosition);
+		// Draws the loaded chunks that intersect frustum, or all of them without one.
+		void Draw(const Frustum* frustum = nullptr);
+		void Clear();
+
+		bool FindChunk(const vec3i& coord, Chunk*& outChunk) const;
+		// Changes a single voxel, given in world voxel coordinates, and patches the affected meshes in place.
+		// Returns false if the voxel's chunk isn't loaded.
+		bool SetVoxel(const vec3i& worldVoxel, const voxelType type);
+		void SetSettings(const ChunkManagerSettings& settings);
+
+		inline const ChunkManagerSettings& Settings() const { return m_settings; }
+		inline uint32_t LoadedChunkCount() const { return static_cast<uint32_t>(m_loadedChunks.size()); }
+		inline uint32_t PendingChunkCount() const { return static_cast<uint32_t>(m_loadQueue.size() + m_pendingJobs.size()); }
+		inline uint64_t MemoryUsage() const { return m_memoryUsage; }
+		inline uint32_t WarmChunkCount() const { return static_cast<uint32_t>(m_warmChunks.size() + m_pendingDemotions.size()); }
+		inline uint64_t WarmMemoryUsage() const { return m_warmMemoryUsage; }
+		ChunkResidency GetResidency(const vec3i& coord) const;
+		inline const ChunkRenderStats& RenderStats() const { return m_renderStats; }
+
+		static vec3i WorldToChunk(const vec3f& position);
+		static vec3f ChunkToWorld(const vec3i& coord);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+#include <sogl/transform/vec3f.hpp>
+#include <sogl/structure/RangeAllocator.h>
+#include <sogl/rendering/gl/GLMappedBuffer.h>
+#include <sogl/world/data/VoxelVertex.hpp>
+
+namespace sogl {
+	/// <summary>
+	/// <para>One persistently mapped vertex buffer shared by every chunk mesh, drawn with a single
+	/// glMultiDrawElementsIndirect per frame.</para>
+	/// <para>Uploading a mesh copies its vertices into a range of the arena. Drawing one only queues an indirect
+	/// command and the chunk's origin and scale, which voxel.vert reads from an SSBO by gl_DrawID. Flush() submits the
+	/// whole queue, so the GL calls per frame no longer grow with the number of chunks.</para>
+	/// <para>The CPU writes the next frame while the GPU may still be reading the last one. Freed ranges are only
+	/// reused two frames later, and the command and draw data buffers alternate between two halves.</para>
+	/// <para>Meshes hold a handle rather than an offset, so BeginFrame() can compact the arena a little each frame
+	/// when remeshing has left it fragmented, copying ranges on the GPU and retiring their old place.</para>
+	/// </summary>
+	class ChunkArena {
+		// layout fixed by glMultiDrawElementsIndirect
+		struct DrawCommand {
+			uint32_t count;
+			uint32_t instanceCount;
+			uint32_t firstIndex;
+			int32_t baseVertex;
+			uint32_t baseInstance;
+		};
+
+		// one std430 vec4 per draw
+		struct DrawData {
+			float x, y, z;
+			float scale;
+		};
+
+		struct RetiredRange {
+			uint32_t offset;
+			uint32_t frame;
+		};
+
+		// compaction starts once less than this much of the free space is in the largest free range
+		static constexpr float COMPACT_FRAGMENTATION = 0.25f;
+		static const uint32_t COMPACT_VERTICES_PER_FRAME = 64 * 1024;
+
+		// in vertices
+		static RangeAllocator Allocator;
+		static GLMappedBuffer* VertexBuffer;
+		static GLMappedBuffer* CommandBuffer;
+		static GLMappedBuffer* DrawDataBuffer;
+		// GPU only staging for moves whose source and destination overlap, which can't be copied in place
+		static uint32_t CopyBufferID;
+		static uint32_t CopyBufferCapacity;
+		static uint32_t VaoID;
+		static GLsync FrameFence;
+		static std::vector<RetiredRange> Retired;
+		// handle -> offset, INVALID_OFFSET for unused handles
+		static std::vector<uint32_t> HandleOffsets;
+		static std::vector<uint32_t> FreeHandles;
+		// offset -> handle, to find the owner of a range compaction moved
+		static std::unordered_map<uint32_t, uint32_t> OffsetHandles;
+		static std::vector<RangeAllocator::Move> Moves;
+		// draws per half of the command and draw data buffers
+		static uint32_t DrawCapacity;
+		static uint32_t DrawCount;
+		static uint32_t Frame;
+
+		// Copies vertices into a new range, growing the arena if needed, and returns its offset.
+		static uint32_t Store(const VoxelVertex* vertices, const uint32_t count);
+		static void Retire(const uint32_t offset);
+		static void Compact();
+		// Copies a move whose source and destination overlap by way of the copy buffer.
+		static void CopyOverlapping(const RangeAllocator::Move& move);
+		static void GrowVertices(const uint32_t vertexCount);
+		static void GrowDraws();
+		static void BindVertexBuffer();
+	public:
+		static const uint32_t INVALID_OFFSET = RangeAllocator::INVALID_OFFSET;
+		static const uint32_t INVALID_HANDLE = 0xFFFFFFFF;
+		// SSBO binding of the per-draw data in voxel.vert
+		static const uint32_t DRAW_DATA_BINDING = 0;
+
+		// Capacities are starting points, both grow on demand. Call after QuadIndexBuffer::Initialize.
+		static void Initialize(const uint32_t vertexCapacity, const uint32_t drawCapacity);
+		static void Terminate();
+
+		// Copies count vertices into the arena and returns a handle to them. Grows the arena when it is full, which
+		// stalls until the GPU has copied the old contents over. Returns INVALID_HANDLE for count 0.
+		static uint32_t Allocate(const VoxelVertex* vertices, const uint32_t count);
+		// Replaces the vertices behind handle with count new ones, which may be more or fewer. They go to a fresh
+		// range, since the GPU may still be drawing the old one. Returns the handle, which may be new if handle was
+		// INVALID_HANDLE, or INVALID_HANDLE if count is 0 and the handle was freed.
+		static uint32_t Reallocate(const uint32_t handle, const VoxelVertex* vertices, const uint32_t count);
+		// Releases a handle. Its range returns to the arena once the frames that may still draw it are done.
+		static void Free(const uint32_t handle);
+
+		// Starts queueing a frame's draws and takes a compaction step. Call once per frame, before any AddDraw.
+		static void BeginFrame();
+		// Queues quadCount quads of the mesh behind handle, drawn at origin with each mesh voxel scale voxels wide.
+		static void AddDraw(const uint32_t handle, const uint32_t quadCount, const vec3f& origin, const float scale);
+		// Draws everything queued since BeginFrame with the currently bound shader.
+		static void Flush();
+
+		inline static uint32_t Capacity() { return Allocator.Capacity(); }
+		inline static uint32_t UsedVertices() { return Allocator.UsedSize(); }
+		inline static float Fragmentation() { return Allocator.Fragmentation(); }
+		// Current offset of a handle's vertices, only valid until the next BeginFrame.
+		inline static uint32_t OffsetOf(const uint32_t handle) { return handle < HandleOffsets.size() ? HandleOffsets[handle] : INVALID_OFFSET; }
+	};
+}
\ No newline at end of file
@@ -23,7 +23,7 @@ namespace sogl {
 		}
 	}
 	
-	uint32_t NormalIndex(const FaceDirection dir) {
+	inline uint32_t NormalIndex(const FaceDirection dir) {
 		switch (dir) {
 			case FaceDirection::left: 
 				return 0;
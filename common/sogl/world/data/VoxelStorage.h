@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace sogl {
+	/// <summary>
+	/// <para>Palette-compressed array of voxel types.</para>
+	/// <para>Each distinct value is stored once in a palette, and every element stores a bit-packed index into it.
+	/// Index widths are 1, 2, 4 or 8 bits so an index never straddles two words. A palette with a single entry
+	/// stores no indices at all, so uniform (all air, all stone...) arrays cost a few bytes.</para>
+	/// </summary>
+	class VoxelStorage {
+		std::vector<uint8_t> m_palette;
+		std::vector<uint64_t> m_indices;
+		uint32_t m_size;
+		uint8_t m_bitsPerIndex;
+
+		static uint8_t BitsForPaletteSize(const uint32_t paletteSize);
+		void Resize(const uint8_t bitsPerIndex);
+		uint32_t FindOrAddPaletteEntry(const uint8_t value);
+
+		inline uint32_t GetIndex(const uint32_t i) const {
+			const uint32_t bit = i * m_bitsPerIndex;
+			const uint64_t mask = (1ull << m_bitsPerIndex) - 1;
+			return static_cast<uint32_t>((m_indices[bit >> 6] >> (bit & 63)) & mask);
+		}
+
+		inline void SetIndex(const uint32_t i, const uint32_t paletteIndex) {
+			const uint32_t bit = i * m_bitsPerIndex;
+			const uint64_t mask = (1ull << m_bitsPerIndex) - 1;
+			uint64_t& word = m_indices[bit >> 6];
+			word = (word & ~(mask << (bit & 63))) | (static_cast<uint64_t>(paletteIndex) << (bit & 63));
+		}
+	public:
+		VoxelStorage(const uint32_t size = 0, const uint8_t fillValue = 0);
+
+		inline uint8_t Get(const uint32_t i) const {
+			if (m_bitsPerIndex == 0)
+				return m_palette[0];
+
+			return m_palette[GetIndex(i)];
+		}
+
+		void Set(const uint32_t i, const uint8_t value);
+		void Fill(const uint8_t value);
+
+		// Replaces the contents with the given flat array, choosing the smallest palette that fits it.
+		void Pack(const uint8_t* values, const uint32_t count);
+		// Decodes every element into a flat array of Size() bytes.
+		void Unpack(uint8_t* outValues) const;
+		// Sets bit i % 64 of outBits[i / 64] where element i isn't value, straight from the packed indices.
+		// outBits must hold (Size() + 63) / 64 words.
+		void NotEqualMask(const uint8_t value, uint64_t* outBits) const;
+		// Replaces the contents with a palette and index array as returned by Palette() and Indices(), e.g. read back
+		// from disk. The index array may be unaligned and its entries are trusted to be in range of the palette.
+		// Returns false, leaving the storage untouched, if the palette and index width don't fit together.
+		bool Assign(const uint32_t size, const uint8_t* palette, const uint32_t paletteSize, const uint8_t bitsPerIndex, const void* indices);
+		// Drops palette entries that are no longer referenced and shrinks the index width to match.
+		void Compact();
+
+		inline bool IsUniform() const { return m_bitsPerIndex == 0; }
+		inline uint32_t Size() const { return m_size; }
+		inline uint8_t BitsPerIndex() const { return m_bitsPerIndex; }
+		inline const std::vector<uint8_t>& Palette() const { return m_palette; }
+		inline const std::vector<uint64_t>& Indices() const { return m_indices; }
+
+		// Returns the number of heap bytes used by the palette and index array.
+		uint64_t MemoryUsage() const;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace sogl {
+	// Chunk mesh vertex packed into a single 32 bit word, decoded again in voxel.vert.
+	//   bits  0-6   x      (0-64, corners sit on the far side of the last voxel)
+	//   bits  7-13  y
+	//   bits 14-20  z
+	//   bits 21-23  normal index (see NormalIndex)
+	//   bits 24-31  voxel type
+	typedef uint32_t VoxelVertex;
+
+	static const uint32_t VOXEL_VERTEX_POSITION_BITS = 7;
+	static const uint32_t VOXEL_VERTEX_POSITION_MASK = (1u << VOXEL_VERTEX_POSITION_BITS) - 1;
+
+	inline VoxelVertex PackVoxelVertex(const uint32_t x, const uint32_t y, const uint32_t z, const uint32_t normal, const uint32_t type) {
+		return (x & VOXEL_VERTEX_POSITION_MASK) |
+			((y & VOXEL_VERTEX_POSITION_MASK) << 7) |
+			((z & VOXEL_VERTEX_POSITION_MASK) << 14) |
+			((normal & 0x7) << 21) |
+			((type & 0xFF) << 24);
+	}
+
+	inline uint32_t VoxelVertexX(const VoxelVertex v) { return v & VOXEL_VERTEX_POSITION_MASK; }
+	inline uint32_t VoxelVertexY(const VoxelVertex v) { return (v >> 7) & VOXEL_VERTEX_POSITION_MASK; }
+	inline uint32_t VoxelVertexZ(const VoxelVertex v) { return (v >> 14) & VOXEL_VERTEX_POSITION_MASK; }
+	inline uint32_t VoxelVertexNormal(const VoxelVertex v) { return (v >> 21) & 0x7; }
+	inline uint32_t VoxelVertexType(const VoxelVertex v) { return v >> 24; }
+}
\ No newline at end of file
@@ -2,10 +2,16 @@
 
 #include <stdint.h>
 #include <sogl/structure/octree.h>
+#include <sogl/world/data/FaceDirection.hpp>
+#include <sogl/world/data/VoxelStorage.h>
 
-struct FastNoise;
+// Define SOGL_CHUNK_LAYOUT_MORTON to store chunk voxels in Morton (Z-order) instead of linear order.
+// Region files hold voxels in storage order and record the layout, so saves made with one layout don't open
+// with the other.
 
 namespace sogl {
+	class TerrainGenerator;
+
 	enum voxelType : uint8_t {
 		AIR = 0,
 		STONE = 1,
@@ -13,18 +19,56 @@ namespace sogl {
 		GRASS = 3,
 		COBBLESTONE = 4
 	};
+
+	static const uint32_t VOXEL_TYPE_COUNT = 5;
 	
 	typedef struct voxel {
 		uint8_t type;
 		static color getColorForVoxel(const voxel* v);
 	} voxel;
 
+	// Cheap facts about a chunk's voxels, kept up to date by Chunk::setVoxel so meshing and drawing can skip
+	// whole chunks without looking at their voxels. faceConnections lags behind edits until
+	// Chunk::refreshConnections() runs.
+	struct ChunkSummary {
+		// voxels in a chunk, and in one of its boundary slices
+		static const uint32_t VOXELS = 64 * 64 * 64;
+		static const uint32_t FACE_VOXELS = 64 * 64;
+
+		// non-air voxels
+		uint32_t solidCount = 0;
+		// non-air voxels in the boundary slice on each side, indexed by FaceDirection
+		uint16_t faceSolidCount[6] = {};
+		// bit b of faceConnections[a] is set when faces a and b (FaceDirections) are joined by air through the
+		// chunk, so something seen through face a may be seen through b. A face with any air connects to itself.
+		uint8_t faceConnections[6] = {};
+		// every voxel is uniformType. Edits only set it again when they leave the chunk all air.
+		bool uniform = true;
+		uint8_t uniformType = 0;
+
+		inline bool IsEmpty() const { return solidCount == 0; }
+		inline bool IsFull() const { return solidCount == VOXELS; }
+		inline bool IsFaceSolid(const FaceDirection side) const { return faceSolidCount[static_cast<uint32_t>(side)] == FACE_VOXELS; }
+		inline bool CanSeeThrough(const FaceDirection from, const FaceDirection to) const {
+			return (faceConnections[static_cast<uint32_t>(from)] >> static_cast<uint32_t>(to)) & 1;
+		}
+	};
+
 	typedef struct Chunk {
-	private:
-		static struct ShaderProgram* chunkShader;
-		static struct Mesh* cubeMesh;
-		static FastNoise* noiseData;
 	public:
+		enum class Layout {
+			// x fastest, then y, then z
+			linear,
+			// x, y and z bits interleaved (x lowest), so every aligned 2x2x2, 4x4x4... block is contiguous
+			morton
+		};
+
+#ifdef SOGL_CHUNK_LAYOUT_MORTON
+		static const Layout LAYOUT = Layout::morton;
+#else
+		static const Layout LAYOUT = Layout::linear;
+#endif
+
 		static const uint64_t CHUNK_SIZE = 64;
 		static const uint16_t CHUNK_SIZE_X = 64;
 		static const uint16_t CHUNK_SIZE_Z = 64;
@@ -33,18 +77,107 @@ namespace sogl {
 		static struct color voxelColors[5];
 	private:
 		vec3f chunkCoords;
-		struct VertexArray* vao;
-		uint32_t voxelBufferID;
-		struct GLMappedBuffer* voxelBuffer;
-		voxel* voxels;
-		static bool indexInRange(const uint16_t index);
+		// palette-compressed, so mostly uniform chunks cost a fraction of the flat 256KB array
+		VoxelStorage voxels;
+		ChunkSummary summary;
+		// an edit opened or closed a voxel since faceConnections was last flood filled
+		bool connectionsStale;
+		static bool indexInRange(const uint16_t x, const uint16_t y, const uint16_t z);
+
+		// 6 bits to every third bit of 18
+		static inline uint32_t mortonSpread(uint32_t v) {
+			v = (v | (v << 8)) & 0x0000F00F;
+			v = (v | (v << 4)) & 0x000C30C3;
+			v = (v | (v << 2)) & 0x00249249;
+			return v;
+		}
+
+		static inline uint16_t mortonCompact(uint32_t v) {
+			v &= 0x00249249;
+			v = (v | (v >> 2)) & 0x000C30C3;
+			v = (v | (v >> 4)) & 0x0000F00F;
+			v = (v | (v >> 8)) & 0x0000003F;
+			return static_cast<uint16_t>(v);
+		}
+
+		// Recounts the summary from the voxels.
+		void summarize();
 	public:
-		static void initialize();
-		Chunk(const vec3f& chunkCoords);
-		void draw();
+		// One solid bit per voxel of a chunk's storage, word y + z * size holding the x row, whatever the layout.
+		static void solidRows(const VoxelStorage& voxels, uint64_t* outRows);
+
+		// Index of a voxel in the chunk's storage.
+		static inline uint32_t voxelIndex(const uint16_t x, const uint16_t y, const uint16_t z) {
+#ifdef SOGL_CHUNK_LAYOUT_MORTON
+			return mortonSpread(x) | (mortonSpread(y) << 1) | (mortonSpread(z) << 2);
+#else
+			return (z * CHUNK_SIZE_X * CHUNK_SIZE_Y) + (y * CHUNK_SIZE_X) + x;
+#endif
+		}
+
+		// Inverse of voxelIndex.
+		static inline void voxelCoords(const uint32_t index, uint16_t& outX, uint16_t& outY, uint16_t& outZ) {
+#ifdef SOGL_CHUNK_LAYOUT_MORTON
+			outX = mortonCompact(index);
+			outY = mortonCompact(index >> 1);
+			outZ = mortonCompact(index >> 2);
+#else
+			outX = index % CHUNK_SIZE_X;
+			outY = (index / CHUNK_SIZE_X) % CHUNK_SIZE_Y;
+			outZ = static_cast<uint16_t>(index / (CHUNK_SIZE_X * CHUNK_SIZE_Y));
+#endif
+		}
+
+		// Calls visit(index, x, y, z) for every voxel, in storage order so the walk over memory is contiguous.
+		template<typename F>
+		static inline void forEachVoxel(F&& visit) {
+#ifdef SOGL_CHUNK_LAYOUT_MORTON
+			// 8x8x8 blocks: the high 9 index bits pick the block, the low 9 bits the voxel within it
+			for (uint32_t block = 0; block < 512; block++) {
+				const uint16_t blockX = mortonCompact(block) << 3;
+				const uint16_t blockY = mortonCompact(block >> 1) << 3;
+				const uint16_t blockZ = mortonCompact(block >> 2) << 3;
+
+				for (uint32_t low = 0; low < 512; low++) {
+					const uint16_t x = blockX | (low & 1) | ((low >> 2) & 2) | ((low >> 4) & 4);
+					const uint16_t y = blockY | ((low >> 1) & 1) | ((low >> 3) & 2) | ((low >> 5) & 4);
+					const uint16_t z = blockZ | ((low >> 2) & 1) | ((low >> 4) & 2) | ((low >> 6) & 4);
+					visit((block << 9) | low, x, y, z);
+				}
+			}
+#else
+			uint32_t index = 0;
+			for (uint16_t z = 0; z < CHUNK_SIZE_Z; z++) {
+				for (uint16_t y = 0; y < CHUNK_SIZE_Y; y++) {
+					for (uint16_t x = 0; x < CHUNK_SIZE_X; x++, index++) {
+						visit(index, x, y, z);
+					}
+				}
+			}
+#endif
+		}
+
+		// Generates the voxel data. Does not touch GL, so chunks can be built on worker threads.
+		// Rendering goes through ChunkMesh.
+		Chunk(const vec3f& chunkCoords, const TerrainGenerator& generator);
+		// Wraps voxel data that was generated earlier, e.g. loaded back from a region file.
+		Chunk(const vec3f& chunkCoords, const VoxelStorage& voxels);
+		Chunk(const Chunk&) = delete;
+
+		inline const vec3f& getChunkCoords() const { return chunkCoords; }
+		// Returns the number of bytes of CPU-side voxel data owned by this chunk.
+		uint64_t getMemoryUsage() const;
+
+		inline const VoxelStorage& getStorage() const { return voxels; }
+		inline const ChunkSummary& getSummary() const { return summary; }
 
-		voxel* const getVoxel(const uint16_t x, const uint16_t y, const uint16_t z);
-		bool getVoxelNeighbours(const uint16_t x, const uint16_t y, const uint16_t z, voxel**& outNeighbours);
-		void setVoxel(voxel* voxel, const voxelType type);
+		// Out of range coordinates read as AIR.
+		voxel getVoxel(const uint16_t x, const uint16_t y, const uint16_t z) const;
+		// Neighbours are ordered +x, -x, +y, -y, +z, -z. Neighbours outside the chunk read as AIR.
+		bool getVoxelNeighbours(const uint16_t x, const uint16_t y, const uint16_t z, voxel (&outNeighbours)[6]) const;
+		void setVoxel(const uint16_t x, const uint16_t y, const uint16_t z, const voxelType type);
+		// Flood fills the summary's faceConnections again if an edit opened or closed a voxel since the last fill.
+		// Edits only mark them stale, so a burst of edits costs one fill when the connections are next needed.
+		void refreshConnections();
 	};
 }
\ No newline at end of file
@@ -1,13 +1,119 @@
 #pragma once
 
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include <sogl/transform/vec3f.hpp>
+#include <sogl/world/data/FaceDirection.hpp>
+#include <sogl/world/data/VoxelVertex.hpp>
+
 namespace sogl {
+	class VoxelStorage;
+	struct ChunkSummary;
+
+	// Solid bits of the neighbouring chunks' slices that touch this chunk, one 64x64 plane per FaceDirection,
+	// laid out like that direction's face planes. Missing neighbours are left zeroed and read as air.
+	struct ChunkBorders {
+		uint64_t solid[6][64] = {};
+	};
+
+	/// <summary>
+	/// <para>Greedy-meshed surface of a single chunk.</para>
+	/// <para>Solid voxels are packed into column bitsets, faces for each slice are found with a couple of
+	/// bitwise ops per row, bucketed into dense per-type planes and merged into quads. All intermediate data lives
+	/// in fixed-size arrays, so meshing a chunk doesn't allocate beyond the output.</para>
+	/// <para>Vertices are kept grouped by (direction, slice), so a voxel edit only remeshes the slices through it
+	/// and rewrites the changed range of the vertex buffer.</para>
+	/// <para>Distant chunks can be meshed at a level of detail: the voxels are first downsampled 2x, 4x or 8x per
+	/// axis, keeping a cell solid if any voxel in it is and giving it the type of its topmost solid voxel, so thin
+	/// surfaces never open up. The same mesher then runs on the smaller grid and the shader scales it back up.</para>
+	/// <para>Uploaded vertices live in the shared ChunkArena, and Draw() only queues the mesh for the arena's single
+	/// multi-draw in EndDraw().</para>
+	/// <para>Meshing is GL-free and can run on any thread; Upload() and Draw() must run on the GL thread.</para>
+	/// </summary>
 	typedef class ChunkMesh {
-		void ConstructAxisBitset(Chunk* chunk, uint64_t*& outBitset);
-		void GreedyMeshBinaryPlane(std::vector<struct GreedyQuad>* quadVerts, uint64_t* planeData);
-		static vec3f WorldToSample(enum FaceDirection dir, uint64_t axis, uint64_t x, uint64_t y);
-		static void AppendVertices(GreedyQuad quad, std::vector<vec3f>* vertices, std::vector<uint32_t>* normals, FaceDirection faceDir, uint64_t axis, uint64_t blockType);
+		static struct ShaderProgram* Shader;
+
+		// one segment of vertices per (direction, slice), so an edit only has to remesh the slices it touches
+		static const uint32_t SEGMENT_COUNT = 6 * 64;
+
+		uint32_t m_quadCount;
+		// each mesh voxel covers (1 << m_lod) voxels per axis
+		uint8_t m_lod;
+		// four packed vertices per quad, counter-clockwise, ordered by segment
+		std::vector<VoxelVertex> m_vertices;
+		// first vertex of each segment (direction * size + slice), the last entry is the vertex count
+		uint32_t m_segmentStart[SEGMENT_COUNT + 1];
+		ChunkBorders m_borders;
+		// solid column bitsets, only kept around once the mesh has been edited
+		std::unique_ptr<struct ChunkColumns> m_columns;
+
+		bool m_uploaded;
+		// vertices in the ChunkArena, ChunkArena::INVALID_HANDLE while there are none there
+		uint32_t m_arenaHandle;
+
+		static void ConstructColumns(const VoxelStorage& voxels, ChunkColumns& outColumns);
+		// Only the first size slices, rows and bits are used, the rest of the columns must be air.
+		static void BuildFacePlane(FaceDirection dir, uint64_t slice, const uint64_t size, const ChunkColumns& columns, const uint64_t* border, uint64_t* outPlane);
+		void MeshSlice(const VoxelStorage& voxels, const uint32_t solidTypes, const uint8_t singleType, FaceDirection dir, uint64_t slice, const ChunkColumns& columns, struct ChunkMeshScratch& scratch) const;
+		// Remeshes the given segments, splices them into the vertex list and replaces the GPU copy.
+		void RemeshSegments(const VoxelStorage& voxels, uint32_t* dirtySegments, const uint32_t dirtyCount);
+		void Reupload();
+		static void GreedyMeshBinaryPlane(std::vector<struct GreedyQuad>* quadVerts, uint64_t* planeData);
+		static VoxelVertex WorldToSample(FaceDirection dir, uint64_t axis, uint64_t x, uint64_t y, uint32_t blockType);
+		static void AppendVertices(const GreedyQuad& quad, std::vector<VoxelVertex>* vertices, FaceDirection faceDir, uint64_t axis, uint32_t blockType);
+		// Shrinks voxels by 1 << lod per axis into the first CHUNK_SIZE >> lod bits of outColumns, with the type of
+		// each cell in outTypes at x + (y + z * size) * size. Returns a bit per solid type used.
+		static uint32_t Downsample(const VoxelStorage& voxels, const uint32_t lod, ChunkColumns& outColumns, uint8_t* outTypes);
+		// Shrinks a border plane the same way. A cell is only solid if every voxel it covers is, so faces are never
+		// culled against a neighbour that is open anywhere in front of them.
+		static void DownsampleBorder(const uint64_t* plane, const uint32_t lod, uint64_t* outPlane);
 	public:
-		struct Mesh* meshData;
-		ChunkMesh(struct Chunk& chunk);
+		// Coarsest level of detail, 8x8x8 voxels per mesh voxel.
+		static const uint32_t MAX_LOD = 3;
+
+		// Faces against solid voxels in the given neighbour borders are culled. Without borders every face on the
+		// chunk boundary is kept.
+		// lod above 0 meshes the chunk downsampled by 1 << lod per axis.
+		ChunkMesh(const struct Chunk& chunk, const ChunkBorders* borders = nullptr, const uint32_t lod = 0);
+		// With the voxels' summary, empty chunks are skipped outright and full chunks only mesh their boundary slices.
+		ChunkMesh(const VoxelStorage& voxels, const ChunkBorders* borders = nullptr, const ChunkSummary* summary = nullptr, const uint32_t lod = 0);
+		ChunkMesh(const ChunkMesh&) = delete;
+		// Releases the arena range, so meshes that were uploaded must be deleted on the GL thread.
+		~ChunkMesh();
+
+		// Writes the slice of neighbour that touches a chunk on the given side into outPlane, in the layout
+		// ChunkBorders expects for that side.
+		static void ExtractBorder(const VoxelStorage& neighbour, FaceDirection side, uint64_t* outPlane);
+
+		// Loads the chunk shader. Called once from glInitialize.
+		static void Initialize();
+		// Binds the chunk shader and starts queueing Draw() calls. Once per frame.
+		static void BeginDraw();
+		// Draws everything queued since BeginDraw() in one call.
+		static void EndDraw();
+
+		// Updates the mesh after the voxel at (x, y, z) changed in voxels. Only the six slices through the voxel
+		// are remeshed before the vertices are sent to the GPU again. Full detail meshes only; a
+		// level-of-detail mesh has to be rebuilt.
+		void ApplyEdit(const VoxelStorage& voxels, const uint16_t x, const uint16_t y, const uint16_t z);
+		// Updates the mesh after the neighbour on the given side changed the voxel at (x, y, z) of its own boundary
+		// slice, in the neighbour's local coordinates. Full detail meshes only.
+		void ApplyBorderEdit(const VoxelStorage& voxels, FaceDirection side, const uint16_t x, const uint16_t y, const uint16_t z, const bool solid);
+
+		// Copies the packed vertices into the ChunkArena. Indices come from the shared QuadIndexBuffer.
+		void Upload();
+		// Queues the uploaded mesh at the given chunk origin. Must be between BeginDraw() and EndDraw().
+		void Draw(const vec3f& chunkCoords) const;
+
+		inline bool IsUploaded() const { return m_uploaded; }
+		inline uint32_t Lod() const { return m_lod; }
+		inline uint32_t QuadCount() const { return m_quadCount; }
+		inline uint32_t TriangleCount() const { return m_quadCount * 2; }
+		inline const std::vector<VoxelVertex>& Vertices() const { return m_vertices; }
+
+		// Returns the number of bytes of CPU-side mesh data owned by this mesh.
+		uint64_t MemoryUsage() const;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include <GLEW/glew.h>
+
+#include <string.h>
+
+#include <sogl/world/data/ChunkArena.h>
+#include <sogl/rendering/gl/QuadIndexBuffer.h>
+
+namespace sogl {
+	RangeAllocator ChunkArena::Allocator;
+	GLMappedBuffer* ChunkArena::VertexBuffer = nullptr;
+	GLMappedBuffer* ChunkArena::CommandBuffer = nullptr;
+	GLMappedBuffer* ChunkArena::DrawDataBuffer = nullptr;
+	uint32_t ChunkArena::CopyBufferID = 0;
+	uint32_t ChunkArena::CopyBufferCapacity = 0;
+	uint32_t ChunkArena::VaoID = 0;
+	GLsync ChunkArena::FrameFence = nullptr;
+	std::vector<ChunkArena::RetiredRange> ChunkArena::Retired;
+	std::vector<uint32_t> ChunkArena::HandleOffsets;
+	std::vector<uint32_t> ChunkArena::FreeHandles;
+	std::unordered_map<uint32_t, uint32_t> ChunkArena::OffsetHandles;
+	std::vector<RangeAllocator::Move> ChunkArena::Moves;
+	uint32_t ChunkArena::DrawCapacity = 0;
+	uint32_t ChunkArena::DrawCount = 0;
+	uint32_t ChunkArena::Frame = 0;
+
+	void ChunkArena::Initialize(const uint32_t vertexCapacity, const uint32_t drawCapacity) {
+		if (VaoID != 0)
+			return;
+
+		VertexBuffer = new GLMappedBuffer(vertexCapacity * sizeof(VoxelVertex), GL_MAP_WRITE_BIT);
+		Allocator.Reset(vertexCapacity);
+
+		// a multiple of 64 draws keeps the second half's SSBO offset aligned on any implementation
+		DrawCapacity = (drawCapacity + 63) & ~63u;
+		CommandBuffer = new GLMappedBuffer(2 * DrawCapacity * sizeof(DrawCommand), GL_MAP_WRITE_BIT);
+		DrawDataBuffer = new GLMappedBuffer(2 * DrawCapacity * sizeof(DrawData), GL_MAP_WRITE_BIT);
+		DrawCount = 0;
+		Frame = 0;
+
+		glGenVertexArrays(1, &VaoID);
+		BindVertexBuffer();
+	}
+
+	void ChunkArena::Terminate() {
+		if (VaoID == 0)
+			return;
+
+		if (FrameFence != nullptr) {
+			glDeleteSync(FrameFence);
+			FrameFence = nullptr;
+		}
+
+		glDeleteVertexArrays(1, &VaoID);
+		VaoID = 0;
+
+		if (CopyBufferID != 0) {
+			glDeleteBuffers(1, &CopyBufferID);
+			CopyBufferID = 0;
+			CopyBufferCapacity = 0;
+		}
+
+		GLMappedBuffer** buffers[3] = { &VertexBuffer, &CommandBuffer, &DrawDataBuffer };
+		for (GLMappedBuffer** buffer : buffers) {
+			(*buffer)->destroy();
+			delete *buffer;
+			*buffer = nullptr;
+		}
+
+		Allocator.Reset(0);
+		Retired.clear();
+		HandleOffsets.clear();
+		FreeHandles.clear();
+		OffsetHandles.clear();
+	}
+
+	uint32_t ChunkArena::Allocate(const VoxelVertex* vertices, const uint32_t count) {
+		return Reallocate(INVALID_HANDLE, vertices, count);
+	}
+
+	uint32_t ChunkArena::Reallocate(const uint32_t handle, const VoxelVertex* vertices, const uint32_t count) {
+		if (VaoID == 0)
+			return INVALID_HANDLE;
+
+		if (count == 0) {
+			Free(handle);
+			return INVALID_HANDLE;
+		}
+
+		uint32_t result = handle;
+		if (result == INVALID_HANDLE) {
+			if (!FreeHandles.empty()) {
+				result = FreeHandles.back();
+				FreeHandles.pop_back();
+			}
+			else {
+				result = static_cast<uint32_t>(HandleOffsets.size());
+				HandleOffsets.resize(result + 1);
+			}
+		}
+		else {
+			Retire(HandleOffsets[result]);
+		}
+
+		const uint32_t offset = Store(vertices, count);
+		HandleOffsets[result] = offset;
+		OffsetHandles[offset] = result;
+		return result;
+	}
+
+	void ChunkArena::Free(const uint32_t handle) {
+		if (handle == INVALID_HANDLE || VaoID == 0)
+			return;
+
+		// handles never reach the GPU, so they can be reused right away
+		Retire(HandleOffsets[handle]);
+		HandleOffsets[handle] = INVALID_OFFSET;
+		FreeHandles.push_back(handle);
+	}
+
+	void ChunkArena::BeginFrame() {
+		// the fence from the start of the last frame covers every draw up to the frame before it
+		if (FrameFence != nullptr) {
+			GLenum waitReturn = GL_UNSIGNALED;
+			while (waitReturn != GL_ALREADY_SIGNALED && waitReturn != GL_CONDITION_SATISFIED) {
+				waitReturn = glClientWaitSync(FrameFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			}
+			glDeleteSync(FrameFence);
+		}
+		FrameFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		Frame++;
+		DrawCount = 0;
+
+		// so frames up to Frame - 2 are done and nothing they drew is needed anymore
+		size_t kept = 0;
+		for (size_t i = 0; i < Retired.size(); i++) {
+			if (Retired[i].frame + 2 <= Frame) {
+				Allocator.Free(Retired[i].offset);
+			}
+			else {
+				Retired[kept++] = Retired[i];
+			}
+		}
+		Retired.resize(kept);
+
+		Compact();
+	}
+
+	void ChunkArena::AddDraw(const uint32_t handle, const uint32_t quadCount, const vec3f& origin, const float scale) {
+		if (handle == INVALID_HANDLE || quadCount == 0)
+			return;
+
+		const uint32_t offset = HandleOffsets[handle];
+		if (DrawCount == DrawCapacity) {
+			GrowDraws();
+		}
+
+		// this frame's half, the other one may still be in use by the last frame
+		const uint32_t index = (Frame & 1) * DrawCapacity + DrawCount;
+		DrawCommand& command = static_cast<DrawCommand*>(CommandBuffer->pointer)[index];
+		command.count = quadCount * QuadIndexBuffer::INDICES_PER_QUAD;
+		command.instanceCount = 1;
+		command.firstIndex = 0;
+		command.baseVertex = static_cast<int32_t>(offset);
+		command.baseInstance = 0;
+
+		DrawData& data = static_cast<DrawData*>(DrawDataBuffer->pointer)[index];
+		data.x = origin.x;
+		data.y = origin.y;
+		data.z = origin.z;
+		data.scale = scale;
+
+		DrawCount++;
+	}
+
+	void ChunkArena::Flush() {
+		if (DrawCount == 0)
+			return;
+
+		const uint32_t first = (Frame & 1) * DrawCapacity;
+		glBindVertexArray(VaoID);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, DrawDataBuffer->ID, first * sizeof(DrawData), DrawCount * sizeof(DrawData));
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, CommandBuffer->ID);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(static_cast<uintptr_t>(first * sizeof(DrawCommand))), DrawCount, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		glBindVertexArray(0);
+
+		DrawCount = 0;
+	}
+
+	uint32_t ChunkArena::Store(const VoxelVertex* vertices, const uint32_t count) {
+		uint32_t offset = Allocator.Allocate(count);
+		if (offset == INVALID_OFFSET) {
+			GrowVertices(count);
+			offset = Allocator.Allocate(count);
+		}
+
+		// the range is either new or retired at least two frames ago, so the GPU isn't reading it
+		memcpy(static_cast<VoxelVertex*>(VertexBuffer->pointer) + offset, vertices, count * sizeof(VoxelVertex));
+		return offset;
+	}
+
+	void ChunkArena::Retire(const uint32_t offset) {
+		if (offset == INVALID_OFFSET)
+			return;
+
+		// compaction would only copy data nobody needs anymore
+		Allocator.Pin(offset);
+		OffsetHandles.erase(offset);
+		Retired.push_back(RetiredRange{ offset, Frame });
+	}
+
+	void ChunkArena::Compact() {
+		if (Allocator.Fragmentation() < COMPACT_FRAGMENTATION)
+			return;
+
+		Moves.clear();
+		if (Allocator.Compact(COMPACT_VERTICES_PER_FRAME, Moves) == 0)
+			return;
+
+		// the destinations were free for at least two frames, and the copies run before this frame's draws, which
+		// already use the new offsets. the sources may still be drawn by the last frame, so they're retired. a
+		// destination overlapping its source only covers the part the GPU copies, which waits for those draws.
+		for (const RangeAllocator::Move& move : Moves) {
+			if (move.to + move.size > move.from) {
+				CopyOverlapping(move);
+			}
+			else {
+				glBindBuffer(GL_COPY_READ_BUFFER, VertexBuffer->ID);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, VertexBuffer->ID);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+					move.from * sizeof(VoxelVertex), move.to * sizeof(VoxelVertex), move.size * sizeof(VoxelVertex));
+			}
+
+			// retired ranges are pinned, so everything moved still has an owner
+			auto owner = OffsetHandles.find(move.from);
+			const uint32_t handle = owner->second;
+			OffsetHandles.erase(owner);
+			OffsetHandles[move.to] = handle;
+			HandleOffsets[handle] = move.to;
+
+			Retired.push_back(RetiredRange{ move.from, Frame });
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	void ChunkArena::CopyOverlapping(const RangeAllocator::Move& move) {
+		if (CopyBufferCapacity < move.size) {
+			if (CopyBufferID == 0) {
+				glGenBuffers(1, &CopyBufferID);
+			}
+
+			// the old contents are never needed, and GL keeps them alive for copies already submitted
+			CopyBufferCapacity = COMPACT_VERTICES_PER_FRAME;
+			if (CopyBufferCapacity < move.size) {
+				CopyBufferCapacity = move.size;
+			}
+			glBindBuffer(GL_COPY_WRITE_BUFFER, CopyBufferID);
+			glBufferData(GL_COPY_WRITE_BUFFER, CopyBufferCapacity * sizeof(VoxelVertex), nullptr, GL_STREAM_COPY);
+		}
+
+		const uint32_t size = move.size * sizeof(VoxelVertex);
+		glBindBuffer(GL_COPY_READ_BUFFER, VertexBuffer->ID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, CopyBufferID);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, move.from * sizeof(VoxelVertex), 0, size);
+		glBindBuffer(GL_COPY_READ_BUFFER, CopyBufferID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, VertexBuffer->ID);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, move.to * sizeof(VoxelVertex), size);
+	}
+
+	void ChunkArena::GrowVertices(const uint32_t vertexCount) {
+		uint32_t capacity = Allocator.Capacity() > 0 ? Allocator.Capacity() : 1024;
+		while (capacity - Allocator.Capacity() < vertexCount) {
+			capacity *= 2;
+		}
+
+		// persistent storage can't be resized, so the contents move to a bigger buffer. offsets stay the same.
+		GLMappedBuffer* grown = new GLMappedBuffer(capacity * sizeof(VoxelVertex), GL_MAP_WRITE_BIT);
+		glBindBuffer(GL_COPY_READ_BUFFER, VertexBuffer->ID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, grown->ID);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, VertexBuffer->size);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		// the copy would overwrite anything the CPU writes into the new buffer before it runs. growing is rare
+		// enough to just wait for it.
+		glFinish();
+
+		VertexBuffer->destroy();
+		delete VertexBuffer;
+		VertexBuffer = grown;
+		Allocator.Grow(capacity);
+		BindVertexBuffer();
+	}
+
+	void ChunkArena::GrowDraws() {
+		const uint32_t capacity = DrawCapacity * 2;
+		GLMappedBuffer* commands = new GLMappedBuffer(2 * capacity * sizeof(DrawCommand), GL_MAP_WRITE_BIT);
+		GLMappedBuffer* drawData = new GLMappedBuffer(2 * capacity * sizeof(DrawData), GL_MAP_WRITE_BIT);
+
+		// only this frame's draws are still needed. the old buffers are deleted, but GL keeps them alive for
+		// draws already submitted.
+		const uint32_t half = Frame & 1;
+		memcpy(static_cast<DrawCommand*>(commands->pointer) + half * capacity,
+			static_cast<DrawCommand*>(CommandBuffer->pointer) + half * DrawCapacity, DrawCount * sizeof(DrawCommand));
+		memcpy(static_cast<DrawData*>(drawData->pointer) + half * capacity,
+			static_cast<DrawData*>(DrawDataBuffer->pointer) + half * DrawCapacity, DrawCount * sizeof(DrawData));
+
+		CommandBuffer->destroy();
+		delete CommandBuffer;
+		CommandBuffer = commands;
+
+		DrawDataBuffer->destroy();
+		delete DrawDataBuffer;
+		DrawDataBuffer = drawData;
+
+		DrawCapacity = capacity;
+	}
+
+	void ChunkArena::BindVertexBuffer() {
+		glBindVertexArray(VaoID);
+		glBindBuffer(GL_ARRAY_BUFFER, VertexBuffer->ID);
+		// integer attribute, the shader unpacks it
+		glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(VoxelVertex), (void*)0);
+		glEnableVertexAttribArray(0);
+		// element buffer binding is VAO state, and every draw indexes the shared quad indices from its base vertex
+		QuadIndexBuffer::Bind();
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
\ No newline at end of file
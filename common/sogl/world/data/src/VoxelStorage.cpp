@@ -0,0 +1,288 @@
+#include <string.h>
+#include <assert.h>
+
+#include <sogl/world/data/VoxelStorage.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOGL_VOXEL_SSE2
+#endif
+
+namespace sogl {
+	// Gathers the lowest bit of every bitsPerIndex wide field into the low 64 / bitsPerIndex bits.
+	static inline uint64_t CompressFieldBits(uint64_t word, const uint8_t bitsPerIndex) {
+		switch (bitsPerIndex) {
+		case 2:
+			word &= 0x5555555555555555ull;
+			word = (word | (word >> 1)) & 0x3333333333333333ull;
+			word = (word | (word >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+			word = (word | (word >> 4)) & 0x00FF00FF00FF00FFull;
+			word = (word | (word >> 8)) & 0x0000FFFF0000FFFFull;
+			return (word | (word >> 16)) & 0x00000000FFFFFFFFull;
+		case 4:
+			word &= 0x1111111111111111ull;
+			word = (word | (word >> 3)) & 0x0303030303030303ull;
+			word = (word | (word >> 6)) & 0x000F000F000F000Full;
+			word = (word | (word >> 12)) & 0x000000FF000000FFull;
+			return (word | (word >> 24)) & 0x000000000000FFFFull;
+		case 8:
+			word &= 0x0101010101010101ull;
+			word = (word | (word >> 7)) & 0x0003000300030003ull;
+			word = (word | (word >> 14)) & 0x0000000F0000000Full;
+			return (word | (word >> 28)) & 0x00000000000000FFull;
+		default:
+			return word;
+		}
+	}
+
+	VoxelStorage::VoxelStorage(const uint32_t size, const uint8_t fillValue)
+		: m_palette(1, fillValue), m_indices(), m_size(size), m_bitsPerIndex(0) {}
+
+	uint8_t VoxelStorage::BitsForPaletteSize(const uint32_t paletteSize) {
+		// only power of two widths, so 64 bit words always hold a whole number of indices
+		if (paletteSize <= 1)
+			return 0;
+		if (paletteSize <= 2)
+			return 1;
+		if (paletteSize <= 4)
+			return 2;
+		if (paletteSize <= 16)
+			return 4;
+		return 8;
+	}
+
+	void VoxelStorage::Resize(const uint8_t bitsPerIndex) {
+		if (bitsPerIndex == m_bitsPerIndex)
+			return;
+
+		std::vector<uint64_t> indices;
+		if (bitsPerIndex > 0) {
+			indices.assign((static_cast<uint64_t>(m_size) * bitsPerIndex + 63) / 64, 0);
+		}
+
+		const uint8_t oldBits = m_bitsPerIndex;
+		m_indices.swap(indices);
+		m_bitsPerIndex = bitsPerIndex;
+
+		// a uniform array has no indices, every element implicitly refers to entry 0
+		if (oldBits == 0 || bitsPerIndex == 0)
+			return;
+
+		const uint64_t oldMask = (1ull << oldBits) - 1;
+		for (uint32_t i = 0; i < m_size; i++) {
+			const uint32_t bit = i * oldBits;
+			SetIndex(i, static_cast<uint32_t>((indices[bit >> 6] >> (bit & 63)) & oldMask));
+		}
+	}
+
+	uint32_t VoxelStorage::FindOrAddPaletteEntry(const uint8_t value) {
+		for (uint32_t i = 0; i < m_palette.size(); i++) {
+			if (m_palette[i] == value)
+				return i;
+		}
+
+		m_palette.push_back(value);
+		Resize(BitsForPaletteSize(static_cast<uint32_t>(m_palette.size())));
+		return static_cast<uint32_t>(m_palette.size() - 1);
+	}
+
+	void VoxelStorage::Set(const uint32_t i, const uint8_t value) {
+		assert(i < m_size);
+
+		if (m_bitsPerIndex == 0 && m_palette[0] == value)
+			return;
+
+		SetIndex(i, FindOrAddPaletteEntry(value));
+	}
+
+	void VoxelStorage::Fill(const uint8_t value) {
+		m_palette.assign(1, value);
+		m_indices.clear();
+		m_indices.shrink_to_fit();
+		m_bitsPerIndex = 0;
+	}
+
+	void VoxelStorage::Pack(const uint8_t* values, const uint32_t count) {
+		m_size = count;
+
+		// value -> palette index, built in first-seen order
+		int16_t lookup[256];
+		memset(lookup, 0xFF, sizeof(lookup));
+
+		m_palette.clear();
+		for (uint32_t i = 0; i < count; i++) {
+			if (lookup[values[i]] < 0) {
+				lookup[values[i]] = static_cast<int16_t>(m_palette.size());
+				m_palette.push_back(values[i]);
+			}
+		}
+
+		if (m_palette.empty()) {
+			m_palette.push_back(0);
+		}
+
+		m_bitsPerIndex = BitsForPaletteSize(static_cast<uint32_t>(m_palette.size()));
+		m_indices.assign((static_cast<uint64_t>(m_size) * m_bitsPerIndex + 63) / 64, 0);
+		m_indices.shrink_to_fit();
+
+		if (m_bitsPerIndex == 0)
+			return;
+
+		// indices are written whole words at a time rather than through SetIndex
+		const uint32_t perWord = 64 / m_bitsPerIndex;
+		for (uint32_t w = 0; w < m_indices.size(); w++) {
+			uint64_t word = 0;
+			const uint32_t start = w * perWord;
+			const uint32_t end = start + perWord < count ? start + perWord : count;
+			for (uint32_t i = start; i < end; i++) {
+				word |= static_cast<uint64_t>(lookup[values[i]]) << ((i - start) * m_bitsPerIndex);
+			}
+			m_indices[w] = word;
+		}
+	}
+
+	void VoxelStorage::Unpack(uint8_t* outValues) const {
+		if (m_bitsPerIndex == 0) {
+			memset(outValues, m_palette[0], m_size);
+			return;
+		}
+
+		const uint32_t perWord = 64 / m_bitsPerIndex;
+		const uint64_t mask = (1ull << m_bitsPerIndex) - 1;
+		for (uint32_t w = 0; w < m_indices.size(); w++) {
+			uint64_t word = m_indices[w];
+			const uint32_t start = w * perWord;
+			const uint32_t end = start + perWord < m_size ? start + perWord : m_size;
+			for (uint32_t i = start; i < end; i++) {
+				outValues[i] = m_palette[word & mask];
+				word >>= m_bitsPerIndex;
+			}
+		}
+	}
+
+	void VoxelStorage::NotEqualMask(const uint8_t value, uint64_t* outBits) const {
+		const uint32_t wordCount = (m_size + 63) / 64;
+
+		// palette entries are unique, so at most one index holds value
+		int32_t valueIndex = -1;
+		for (uint32_t i = 0; i < m_palette.size(); i++) {
+			if (m_palette[i] == value) {
+				valueIndex = static_cast<int32_t>(i);
+				break;
+			}
+		}
+
+		if (valueIndex < 0 || m_bitsPerIndex == 0) {
+			memset(outBits, valueIndex < 0 ? 0xFF : 0, wordCount * sizeof(uint64_t));
+		}
+		else {
+			const uint8_t bits = m_bitsPerIndex;
+			const uint32_t perWord = 64 / bits;
+			uint32_t w = 0;
+
+#ifdef SOGL_VOXEL_SSE2
+			// indices are widened to one per byte (in element order, the low field of each byte first), then
+			// compared 16 at a time
+			const __m128i key = _mm_set1_epi8(static_cast<char>(valueIndex));
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(m_indices.data());
+			auto equalMask = [&key](const __m128i indices) {
+				return static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(indices, key))));
+			};
+
+			if (bits == 8) {
+				for (; w < m_size / 64; w++) {
+					uint64_t equal = 0;
+					for (uint32_t part = 0; part < 4; part++) {
+						equal |= equalMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + w * 64 + part * 16))) << (part * 16);
+					}
+					outBits[w] = ~equal;
+				}
+			}
+			else if (bits == 4) {
+				const __m128i low = _mm_set1_epi8(0x0F);
+				for (; w < m_size / 64; w++) {
+					uint64_t equal = 0;
+					for (uint32_t part = 0; part < 2; part++) {
+						const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + w * 32 + part * 16));
+						const __m128i even = _mm_and_si128(packed, low);
+						const __m128i odd = _mm_and_si128(_mm_srli_epi16(packed, 4), low);
+						equal |= equalMask(_mm_unpacklo_epi8(even, odd)) << (part * 32);
+						equal |= equalMask(_mm_unpackhi_epi8(even, odd)) << (part * 32 + 16);
+					}
+					outBits[w] = ~equal;
+				}
+			}
+			else if (bits == 2) {
+				const __m128i low = _mm_set1_epi8(0x03);
+				for (; w < m_size / 64; w++) {
+					const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + w * 16));
+					const __m128i f0 = _mm_and_si128(packed, low);
+					const __m128i f1 = _mm_and_si128(_mm_srli_epi16(packed, 2), low);
+					const __m128i f2 = _mm_and_si128(_mm_srli_epi16(packed, 4), low);
+					const __m128i f3 = _mm_and_si128(_mm_srli_epi16(packed, 6), low);
+					const __m128i f01Low = _mm_unpacklo_epi8(f0, f1);
+					const __m128i f01High = _mm_unpackhi_epi8(f0, f1);
+					const __m128i f23Low = _mm_unpacklo_epi8(f2, f3);
+					const __m128i f23High = _mm_unpackhi_epi8(f2, f3);
+					outBits[w] = ~(equalMask(_mm_unpacklo_epi16(f01Low, f23Low))
+						| (equalMask(_mm_unpackhi_epi16(f01Low, f23Low)) << 16)
+						| (equalMask(_mm_unpacklo_epi16(f01High, f23High)) << 32)
+						| (equalMask(_mm_unpackhi_epi16(f01High, f23High)) << 48));
+				}
+			}
+#endif
+
+			// the rest, or everything without SSE2: fields equal to valueIndex xor to 0. OR-ing every field's bits down
+			// onto its lowest bit leaves that bit set exactly where the element differs, then those bits are packed together
+			const uint64_t pattern = static_cast<uint64_t>(valueIndex) * (~0ull / ((1ull << bits) - 1));
+			for (; w < wordCount; w++) {
+				uint64_t differs = 0;
+				for (uint32_t part = 0; part < bits && w * bits + part < m_indices.size(); part++) {
+					uint64_t fields = m_indices[w * bits + part] ^ pattern;
+					for (uint32_t shift = 1; shift < bits; shift <<= 1) {
+						fields |= fields >> shift;
+					}
+					differs |= CompressFieldBits(fields, bits) << (part * perWord);
+				}
+				outBits[w] = differs;
+			}
+		}
+
+		// bits past the end belong to no element
+		if (m_size % 64 != 0) {
+			outBits[wordCount - 1] &= (1ull << (m_size % 64)) - 1;
+		}
+	}
+
+	bool VoxelStorage::Assign(const uint32_t size, const uint8_t* palette, const uint32_t paletteSize, const uint8_t bitsPerIndex, const void* indices) {
+		if (paletteSize == 0 || paletteSize > 256)
+			return false;
+		if (bitsPerIndex != 0 && bitsPerIndex != 1 && bitsPerIndex != 2 && bitsPerIndex != 4 && bitsPerIndex != 8)
+			return false;
+		if (paletteSize > (1u << bitsPerIndex))
+			return false;
+
+		m_palette.assign(palette, palette + paletteSize);
+		m_size = size;
+		m_bitsPerIndex = bitsPerIndex;
+		m_indices.assign(bitsPerIndex > 0 ? (static_cast<uint64_t>(size) * bitsPerIndex + 63) / 64 : 0, 0);
+		if (!m_indices.empty()) {
+			memcpy(m_indices.data(), indices, m_indices.size() * sizeof(uint64_t));
+		}
+
+		return true;
+	}
+
+	void VoxelStorage::Compact() {
+		if (m_bitsPerIndex == 0)
+			return;
+
+		std::vector<uint8_t> values(m_size);
+		Unpack(values.data());
+		Pack(values.data(), m_size);
+	}
+
+	uint64_t VoxelStorage::MemoryUsage() const {
+		return m_palette.capacity() * sizeof(uint8_t) + m_indices.capacity() * sizeof(uint64_t);
+	}
+}
\ No newline at end of file
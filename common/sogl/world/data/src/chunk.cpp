@@ -1,19 +1,14 @@
-#include <GLEW/glew.h>
+#include <string.h>
+#include <utility>
+#include <vector>
 
+#include <sogl/bitmanip.hpp>
 #include <sogl/world/data/chunk.h>
 #include <sogl/rendering/color.hpp>
 #include <sogl/debug/debug.h>
-#include <sogl/rendering/gl/UniformBuffer.h>
-#include <sogl/rendering/factories/ShaderFactory.h>
-#include <sogl/rendering/factories/MeshFactory.h>
-#include <sogl/rendering/gl/VertexArray.h>
-#include <sogl/noise/fastNoise.h>
+#include <sogl/world/generation/TerrainGenerator.h>
 
 namespace sogl {
-	ShaderProgram* Chunk::chunkShader = nullptr;
-	Mesh* Chunk::cubeMesh = nullptr;
-	FastNoise* Chunk::noiseData = new FastNoise(time(0));
-
 	color Chunk::voxelColors[5] = {
 		color::WHITE,
 		color(0.6, 0.6, 0.6, 1),
@@ -37,80 +32,168 @@ namespace sogl {
 		}
 	}
 
-	void Chunk::initialize() {
-		chunkShader = ShaderFactory::createNew("assets/shader/voxel.vert", "assets/shader/voxel.frag", "chunkShader");
-		chunkShader->use();
-		glUniform3i(glGetUniformLocation(chunkShader->programID, "chunkSize"), CHUNK_SIZE_X, CHUNK_SIZE_Y, CHUNK_SIZE_Z);
-		chunkShader->stop();
+	Chunk::Chunk(const vec3f& chunkCoords, const TerrainGenerator& generator) : chunkCoords(chunkCoords), voxels(CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z, AIR), connectionsStale(false) {
+		// generate into a flat scratch array, then pack it once so the palette only holds what is used
+		static thread_local uint8_t scratch[CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z];
+		generator.Generate(chunkCoords, scratch);
+
+#ifdef SOGL_CHUNK_LAYOUT_MORTON
+		// the generator writes linear order, reorder it writing the destination contiguously
+		static thread_local uint8_t reordered[CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z];
+		forEachVoxel([](uint32_t index, uint16_t x, uint16_t y, uint16_t z) {
+			reordered[index] = scratch[(z * CHUNK_SIZE_Y + y) * CHUNK_SIZE_X + x];
+		});
+		voxels.Pack(reordered, CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z);
+#else
+		voxels.Pack(scratch, CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z);
+#endif
+		summarize();
+	}
+
+	Chunk::Chunk(const vec3f& chunkCoords, const VoxelStorage& voxels) : chunkCoords(chunkCoords), voxels(voxels), connectionsStale(false) {
+		summarize();
+	}
+
+	void Chunk::solidRows(const VoxelStorage& voxels, uint64_t* outRows) {
+#ifdef SOGL_CHUNK_LAYOUT_MORTON
+		static thread_local uint64_t solid[CHUNK_SIZE_Y * CHUNK_SIZE_Z];
+		voxels.NotEqualMask(AIR, solid);
+		memset(outRows, 0, CHUNK_SIZE_Y * CHUNK_SIZE_Z * sizeof(uint64_t));
+		forEachVoxel([&](uint32_t index, uint16_t x, uint16_t y, uint16_t z) {
+			outRows[y + z * CHUNK_SIZE_Y] |= ((solid[index >> 6] >> (index & 63)) & 1) << x;
+		});
+#else
+		// linear storage already is a row per (y, z)
+		voxels.NotEqualMask(AIR, outRows);
+#endif
 	}
 
-	Chunk::Chunk(const vec3f& chunkCoords) : chunkCoords(chunkCoords) {
-		const uint32_t totalVoxels = CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z;
-		uint32_t flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
-		this->voxelBuffer = nullptr;
-
-		this->voxels = new voxel[CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z];
-
-		voxel* v = nullptr;
-		for (int y = 0; y < CHUNK_SIZE_Y; y++) {
-			for (int x = 0; x < CHUNK_SIZE_X; x++) {
-				for (int z = 0; z < CHUNK_SIZE_Z; z++) {
-					if ((v = getVoxel(x, y, z)) != nullptr) {
-						float noise = noiseData->GetPerlin(x, y, z);
-						
-						if (noise < 0.2)
-							v->type = AIR;
-						else if (noise < 0.4)
-							v->type = STONE;
-						else if (noise < 0.6)
-							v->type = DIRT;
-						else if (noise < 0.8)
-							v->type = GRASS;
-						else
-							v->type = COBBLESTONE;
+	// Sets bit b of outConnections[a] when faces a and b (FaceDirections) are joined by air inside the chunk.
+	// Scanline flood fill over the x rows of air: each step fills a whole run of a row at once and hands the run
+	// to the four rows around it as seeds.
+	static void ConnectFaces(const uint64_t* solid, uint8_t (&outConnections)[6]) {
+		const uint16_t size = static_cast<uint16_t>(Chunk::CHUNK_SIZE);
+		const uint16_t last = size - 1;
+		static thread_local uint64_t visited[Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE];
+		static thread_local std::vector<std::pair<uint16_t, uint64_t>> seeds;
+		memset(visited, 0, sizeof(visited));
+		memset(outConnections, 0, sizeof(outConnections));
+
+		// all the air bits connected to seed within free, in both directions along the row
+		auto fillRun = [](uint64_t seed, const uint64_t free) {
+			uint64_t up = seed, down = seed, upFree = free, downFree = free;
+			for (uint32_t shift = 1; shift < 64; shift <<= 1) {
+				up |= upFree & (up << shift);
+				upFree &= upFree << shift;
+				down |= downFree & (down >> shift);
+				downFree &= downFree >> shift;
+			}
+			return up | down;
+		};
+
+		for (uint16_t row = 0; row < size * size; row++) {
+			const uint16_t y = row % size;
+			const uint16_t z = row / size;
+			// only air on the chunk boundary starts a region, anything else can't connect two faces
+			const bool boundaryRow = y == 0 || y == last || z == 0 || z == last;
+			uint64_t starts = ~solid[row] & ~visited[row] & (boundaryRow ? ~0ull : (1ull | (1ull << 63)));
+
+			while (starts != 0) {
+				uint8_t faces = 0;
+				seeds.clear();
+				seeds.emplace_back(row, starts & (~starts + 1));
+
+				while (!seeds.empty()) {
+					const uint16_t seedRow = seeds.back().first;
+					const uint64_t free = ~solid[seedRow] & ~visited[seedRow];
+					uint64_t pending = seeds.back().second & free;
+					seeds.pop_back();
+
+					while (pending != 0) {
+						const uint64_t run = fillRun(pending & (~pending + 1), free);
+						pending &= ~run;
+						visited[seedRow] |= run;
+
+						const uint16_t runY = seedRow % size;
+						const uint16_t runZ = seedRow / size;
+						if (run & 1) faces |= 1 << static_cast<uint32_t>(FaceDirection::left);
+						if (run >> 63) faces |= 1 << static_cast<uint32_t>(FaceDirection::right);
+						if (runY == 0) faces |= 1 << static_cast<uint32_t>(FaceDirection::down);
+						if (runY == last) faces |= 1 << static_cast<uint32_t>(FaceDirection::up);
+						if (runZ == 0) faces |= 1 << static_cast<uint32_t>(FaceDirection::forward);
+						if (runZ == last) faces |= 1 << static_cast<uint32_t>(FaceDirection::back);
+
+						if (runY > 0) seeds.emplace_back(seedRow - 1, run);
+						if (runY < last) seeds.emplace_back(seedRow + 1, run);
+						if (runZ > 0) seeds.emplace_back(seedRow - size, run);
+						if (runZ < last) seeds.emplace_back(seedRow + size, run);
+					}
+				}
+
+				for (uint32_t side = 0; side < 6; side++) {
+					if (faces & (1 << side)) {
+						outConnections[side] |= faces;
 					}
 				}
+
+				starts &= ~visited[row];
 			}
 		}
-		if (cubeMesh == nullptr) {
-			MeshFactory::Find("cube", cubeMesh);
+	}
+
+	void Chunk::summarize() {
+		summary = ChunkSummary();
+		if (voxels.IsUniform()) {
+			summary.uniformType = voxels.Palette()[0];
+			const bool solid = summary.uniformType != AIR;
+			if (solid) {
+				summary.solidCount = ChunkSummary::VOXELS;
+			}
+			for (uint32_t side = 0; side < 6; side++) {
+				summary.faceSolidCount[side] = solid ? ChunkSummary::FACE_VOXELS : 0;
+				summary.faceConnections[side] = solid ? 0 : 0x3F;
+			}
+			return;
 		}
 
-		assert(cubeMesh != nullptr);
+		static thread_local uint64_t solid[CHUNK_SIZE_Y * CHUNK_SIZE_Z];
+		solidRows(voxels, solid);
 
-		vao = new VertexArray(*cubeMesh);
-		glBindVertexArray(vao->ID);
+		// each word is an x row, so the x faces are its end bits and the y and z faces are whole rows
+		uint16_t* faces = summary.faceSolidCount;
+		for (uint16_t z = 0; z < CHUNK_SIZE_Z; z++) {
+			for (uint16_t y = 0; y < CHUNK_SIZE_Y; y++) {
+				const uint64_t row = solid[y + z * CHUNK_SIZE_Y];
+				const uint16_t count = static_cast<uint16_t>(popcount(row));
+				summary.solidCount += count;
+				faces[static_cast<uint32_t>(FaceDirection::left)] += row & 1;
+				faces[static_cast<uint32_t>(FaceDirection::right)] += row >> 63;
+				if (y == 0) faces[static_cast<uint32_t>(FaceDirection::down)] += count;
+				if (y == CHUNK_SIZE_Y - 1) faces[static_cast<uint32_t>(FaceDirection::up)] += count;
+				if (z == 0) faces[static_cast<uint32_t>(FaceDirection::forward)] += count;
+				if (z == CHUNK_SIZE_Z - 1) faces[static_cast<uint32_t>(FaceDirection::back)] += count;
+			}
+		}
 
-		glGenBuffers(1, &this->voxelBufferID);
-		glBindBuffer(GL_ARRAY_BUFFER, voxelBufferID);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(voxel) * totalVoxels, this->voxels, GL_STATIC_DRAW);
-		glVertexAttribPointer(3, 1, GL_UNSIGNED_INT, GL_FALSE, 0, 0);
-		
-		glVertexAttribDivisor(3, 1);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
-	}
+		ConnectFaces(solid, summary.faceConnections);
+		connectionsStale = false;
 
-	voxel* const Chunk::getVoxel(const uint16_t x, const uint16_t y, const uint16_t z) {
-		if (voxels == nullptr)
-			return nullptr;
+		// the palette can hold types that are no longer used, e.g. for chunks loaded from an edited save
+		summary.uniform = summary.solidCount == 0;
+	}
 
-		int index = (z * CHUNK_SIZE_X * CHUNK_SIZE_Y) + (y * CHUNK_SIZE_X) + x;
-		if (!indexInRange(index)) {
-			return nullptr;
+	voxel Chunk::getVoxel(const uint16_t x, const uint16_t y, const uint16_t z) const {
+		if (!indexInRange(x, y, z)) {
+			return voxel{ AIR };
 		}
 
-		return &voxels[index];
+		return voxel{ voxels.Get(voxelIndex(x, y, z)) };
 	}
 
-	bool Chunk::getVoxelNeighbours(const uint16_t x, const uint16_t y, const uint16_t z, voxel**& outNeighbours) {
-		const voxel* v = getVoxel(x, y, z);
-		if (v == nullptr)
+	bool Chunk::getVoxelNeighbours(const uint16_t x, const uint16_t y, const uint16_t z, voxel (&outNeighbours)[6]) const {
+		if (!indexInRange(x, y, z))
 			return false;
-		if (outNeighbours)
-			delete[] outNeighbours;
-		outNeighbours = new voxel*[6];
-		// hard coded for now, to see if it works
+
 		outNeighbours[0] = getVoxel(x + 1, y, z);
 		outNeighbours[1] = getVoxel(x - 1, y, z);
 		outNeighbours[2] = getVoxel(x, y + 1, z);
@@ -121,23 +204,67 @@ namespace sogl {
 		return true;
 	}
 
-	bool Chunk::indexInRange(const uint16_t index) {
-		return index >= 0 && index < CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z;
+	void Chunk::setVoxel(const uint16_t x, const uint16_t y, const uint16_t z, const voxelType type) {
+		if (!indexInRange(x, y, z))
+			return;
+
+		const uint32_t index = voxelIndex(x, y, z);
+		const uint8_t previous = voxels.Get(index);
+		if (previous == type)
+			return;
+
+		voxels.Set(index, type);
+
+		if (summary.uniform && type != summary.uniformType) {
+			summary.uniform = false;
+		}
+
+		const bool wasSolid = previous != AIR;
+		const bool isSolid = type != AIR;
+		if (wasSolid == isSolid)
+			return;
+
+		// +1 or -1, applied to every count the voxel belongs to
+		const uint32_t delta = isSolid ? 1 : ~0u;
+		summary.solidCount += delta;
+		const bool onFace[6] = { y == 0, y == CHUNK_SIZE_Y - 1, x == 0, x == CHUNK_SIZE_X - 1, z == 0, z == CHUNK_SIZE_Z - 1 };
+		for (uint32_t side = 0; side < 6; side++) {
+			if (onFace[side]) {
+				summary.faceSolidCount[side] += static_cast<uint16_t>(delta);
+			}
+		}
+
+		if (summary.solidCount == 0) {
+			summary.uniform = true;
+			summary.uniformType = AIR;
+		}
+
+		// connectivity can't be patched locally, an opened or closed voxel may join or split whole caves, so it is
+		// redone in refreshConnections()
+		connectionsStale = true;
+	}
+
+	void Chunk::refreshConnections() {
+		if (!connectionsStale)
+			return;
+
+		connectionsStale = false;
+		if (summary.IsEmpty()) {
+			memset(summary.faceConnections, 0x3F, sizeof(summary.faceConnections));
+			return;
+		}
+
+		static thread_local uint64_t solid[CHUNK_SIZE_Y * CHUNK_SIZE_Z];
+		solidRows(voxels, solid);
+		ConnectFaces(solid, summary.faceConnections);
+	}
+
+	bool Chunk::indexInRange(const uint16_t x, const uint16_t y, const uint16_t z) {
+		// negative neighbour offsets wrap around to large values, so this also rejects them
+		return x < CHUNK_SIZE_X && y < CHUNK_SIZE_Y && z < CHUNK_SIZE_Z;
 	}
 
-	void Chunk::draw() {
-		chunkShader->use();
-		chunkShader->uploadUniform("chunkCoord", chunkCoords);
-
-		//glBindBuffer(GL_ARRAY_BUFFER, vboID);
-		vao->bind();
-		glEnableVertexAttribArray(3);
-		
-		uint32_t count = CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z;
-		glDrawElementsInstanced(GL_TRIANGLES, vao->pointCount, GL_UNSIGNED_INT, 0, count);
-		
-		glDisableVertexAttribArray(3);
-		vao->unbind();
-		chunkShader->stop();
+	uint64_t Chunk::getMemoryUsage() const {
+		return sizeof(Chunk) + voxels.MemoryUsage();
 	}
 }
\ No newline at end of file
@@ -1,20 +1,21 @@
 #include <GLEW/glew.h>
 
+#include <assert.h>
+#include <algorithm>
+#include <string.h>
 #include <vector>
-#include <map>
 #include <sogl/bitmanip.hpp>
 
 #include <sogl/world/data/FaceDirection.hpp>
-#include <sogl/rendering/gl/mesh/Mesh.h>
-#include <sogl/structure/bitSet.h>
+#include <sogl/world/data/ChunkArena.h>
 #include <sogl/world/data/chunk.h>
-#include <sogl/transform/vec3f.hpp>
 #include <sogl/world/data/chunkMesh.h>
-#include <sogl/rendering/factories/MeshFactory.h>
+#include <sogl/rendering/gl/ShaderProgram.h>
+#include <sogl/rendering/gl/QuadIndexBuffer.h>
+#include <sogl/rendering/factories/ShaderFactory.h>
 
 namespace sogl {
 	static const uint64_t CHUNK_SIZE_2 = Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE;
-	static const uint64_t CHUNK_SIZE_3 = Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE;
 	static const uint64_t U_ONE = 1UL;
 	
 	struct GreedyQuad {
@@ -31,120 +32,545 @@ namespace sogl {
 		}
 	};
 
-	ChunkMesh::ChunkMesh(Chunk& chunkData) {
-		uint64_t* axisColumns = nullptr;
+	struct ChunkColumns {
+		// solid bits along y, indexed x + z * size
+		uint64_t y[CHUNK_SIZE_2];
+		// solid bits along z, indexed x + y * size
+		uint64_t z[CHUNK_SIZE_2];
+	};
 
-		ConstructAxisBitset(&chunkData, axisColumns);
-		assert(axisColumns);
+	// Per-thread working memory for the mesher, reused between chunks so meshing never touches the heap
+	// once the vectors have grown to fit.
+	struct ChunkMeshScratch {
+		ChunkColumns columns;
+		// dense per-type planes for the slice being meshed, kept zeroed between slices
+		uint64_t typePlanes[VOXEL_TYPE_COUNT][Chunk::CHUNK_SIZE] = {};
+		std::vector<GreedyQuad> quads;
+		std::vector<VoxelVertex> vertices;
+		// cell types of a level-of-detail mesh, see Downsample
+		uint8_t lodTypes[CHUNK_SIZE_2 * Chunk::CHUNK_SIZE / 8];
+	};
 
-		uint64_t* columnFaceMasks = new uint64_t[3 * CHUNK_SIZE_3 * 2]{ 0UL };
-		for (uint64_t axis = 0; axis < 3; axis++) {
-			for (uint64_t i = 0; i < CHUNK_SIZE_2; i++) {
-				uint64_t column = axisColumns[(CHUNK_SIZE_2 * axis) + i];
-				columnFaceMasks[(CHUNK_SIZE_2 * (axis * 2 + 1)) + i] = column & ~(column >> 1);
-				columnFaceMasks[(CHUNK_SIZE_2 * (axis * 2 + 0)) + i] = column & ~(column << 1);
+	static ChunkMeshScratch& GetScratch() {
+		static thread_local ChunkMeshScratch scratch;
+		return scratch;
+	}
+
+	// Counts the solid types in the palette. With exactly one, every face has that type.
+	static uint32_t CountSolidTypes(const VoxelStorage& storage, uint8_t& outSingleType) {
+		uint32_t solidTypes = 0;
+		outSingleType = AIR;
+		for (uint8_t type : storage.Palette()) {
+			if (type != AIR) {
+				outSingleType = type;
+				solidTypes++;
 			}
 		}
-		
-		std::map<uint64_t, std::map<uint64_t, uint64_t[Chunk::CHUNK_SIZE]>> data[6]{ std::map<uint64_t, std::map<uint64_t, uint64_t[Chunk::CHUNK_SIZE]>>()};
-		
-		for (uint64_t axis = 0; axis < 6; axis++) {
-			for (uint64_t z = 0; z < Chunk::CHUNK_SIZE; z++) {
-				for (uint64_t x = 0; x < Chunk::CHUNK_SIZE; x++) {
-					uint64_t colIndex = 1 + x + ((z + 1) * Chunk::CHUNK_SIZE) + CHUNK_SIZE_2 * axis;
-					uint64_t column = columnFaceMasks[colIndex];
-					while (column != 0) {
-						uint64_t y = trailing_zeroes(column);
-						column &= column - 1;
-						vec3i pos;
-						switch (axis) {
-							case 0:
-							case 1:
-								pos.set(x, y, z); // down, up
-								break;
-							case 2:
-							case 3:
-								pos.set(y, z, x); // left, right
-								break;
-							default:
-								pos.set(x, z, y); // forward, back
-								break;
-						}
-						voxel* current = chunkData.getVoxel(pos.x, pos.y, pos.z);
-						auto d = data[axis]
-							[current->type]
-							[y];
-						d[x] |= U_ONE << z;
-					}
+
+		return solidTypes;
+	}
+
+	// True when every voxel of the neighbouring slice is solid, so nothing on that side can be seen.
+	static bool IsBorderSolid(const uint64_t* border) {
+		uint64_t all = ~0ull;
+		for (uint64_t row = 0; row < Chunk::CHUNK_SIZE; row++) {
+			all &= border[row];
+		}
+
+		return all == ~0ull;
+	}
+
+	ShaderProgram* ChunkMesh::Shader = nullptr;
+
+	void ChunkMesh::Initialize() {
+		Shader = ShaderFactory::createNew("assets/shader/voxel.vert", "assets/shader/voxel.frag", "chunkShader");
+	}
+
+	void ChunkMesh::BeginDraw() {
+		Shader->use();
+		ChunkArena::BeginFrame();
+	}
+
+	void ChunkMesh::EndDraw() {
+		ChunkArena::Flush();
+		Shader->stop();
+	}
+
+	ChunkMesh::ChunkMesh(const Chunk& chunkData, const ChunkBorders* borders, const uint32_t lod) : ChunkMesh(chunkData.getStorage(), borders, &chunkData.getSummary(), lod) {}
+
+	ChunkMesh::ChunkMesh(const VoxelStorage& voxels, const ChunkBorders* borders, const ChunkSummary* summary, const uint32_t lod)
+		: m_quadCount(0), m_lod(static_cast<uint8_t>(lod)), m_vertices(), m_borders(), m_columns(), m_uploaded(false), m_arenaHandle(ChunkArena::INVALID_HANDLE) {
+		assert(lod <= MAX_LOD);
+		ChunkMeshScratch& scratch = GetScratch();
+		scratch.vertices.clear();
+
+		// neighbours that are solid all over, checked at full detail since downsampled borders only fill a corner
+		uint32_t solidSides = 0;
+		if (borders != nullptr) {
+			for (uint32_t side = 0; side < 6; side++) {
+				if (IsBorderSolid(borders->solid[side])) {
+					solidSides |= 1u << side;
+				}
+
+				if (lod == 0) {
+					memcpy(m_borders.solid[side], borders->solid[side], sizeof(m_borders.solid[side]));
+				}
+				else {
+					DownsampleBorder(borders->solid[side], lod, m_borders.solid[side]);
 				}
 			}
 		}
 
-		std::vector<vec3f> vertices{};
-		std::vector<uint32_t> normals{};
-		for (uint64_t axis = 0; axis < 6; axis++) {
-			auto& blockData = data[axis];
-			FaceDirection faceDir;
-			switch (axis) {
-				case 0:
-					faceDir = FaceDirection::down;
-					break;
-				case 1:
-					faceDir = FaceDirection::up;
-					break;
-				case 2:
-					faceDir = FaceDirection::left;
-					break;
-				case 3:
-					faceDir = FaceDirection::right;
-					break;
-				case 4:
-					faceDir = FaceDirection::forward;
-					break;
-				default:
-					faceDir = FaceDirection::back;
-					break;
+		// inside a full chunk every face is hidden by the next voxel, only the boundary slices can have any
+		const bool boundaryOnly = summary != nullptr && summary->IsFull();
+		bool hidden = summary != nullptr && summary->IsEmpty();
+		if (boundaryOnly) {
+			hidden = solidSides == 0x3F;
+		}
+
+		// a level of detail meshes the downsampled columns, which only fill the first size slices
+		const uint64_t size = Chunk::CHUNK_SIZE >> lod;
+		uint8_t singleType = AIR;
+		uint32_t solidTypes = 0;
+		if (!hidden && lod > 0) {
+			const uint32_t usedTypes = Downsample(voxels, lod, scratch.columns, scratch.lodTypes);
+			solidTypes = static_cast<uint32_t>(popcount(usedTypes));
+			singleType = usedTypes != 0 ? static_cast<uint8_t>(trailing_zeroes(usedTypes)) : static_cast<uint8_t>(AIR);
+		}
+		else if (!hidden) {
+			solidTypes = CountSolidTypes(voxels, singleType);
+			if (solidTypes > 0) {
+				ConstructColumns(voxels, scratch.columns);
 			}
-			for (auto& pair : blockData) {
-				uint64_t blockType = pair.first;
-				for (auto& axisPlane : pair.second) {
-					std::vector<GreedyQuad> quadVertices{};
-					GreedyMeshBinaryPlane(&quadVertices, &axisPlane.second[0]);
-					for (auto& q : quadVertices) {
-						AppendVertices(q, &vertices, &normals, faceDir, axis, blockType);
-					}
+		}
+
+		for (uint32_t segment = 0; segment < SEGMENT_COUNT; segment++) {
+			m_segmentStart[segment] = static_cast<uint32_t>(scratch.vertices.size());
+			if (solidTypes == 0)
+				continue;
+
+			const FaceDirection faceDir = static_cast<FaceDirection>(segment / Chunk::CHUNK_SIZE);
+			const uint64_t slice = segment % Chunk::CHUNK_SIZE;
+			if (slice >= size)
+				continue;
+
+			if (boundaryOnly) {
+				const bool positive = faceDir == FaceDirection::up || faceDir == FaceDirection::right || faceDir == FaceDirection::back;
+				if (slice != (positive ? size - 1 : 0) || (solidSides & (1u << static_cast<uint32_t>(faceDir))) != 0)
+					continue;
+			}
+
+			MeshSlice(voxels, solidTypes, singleType, faceDir, slice, scratch.columns, scratch);
+		}
+		m_segmentStart[SEGMENT_COUNT] = static_cast<uint32_t>(scratch.vertices.size());
+
+		// exact-size copy out of the scratch buffer
+		m_vertices.assign(scratch.vertices.begin(), scratch.vertices.end());
+		m_quadCount = static_cast<uint32_t>(m_vertices.size() / QuadIndexBuffer::VERTICES_PER_QUAD);
+	}
+
+	void ChunkMesh::MeshSlice(const VoxelStorage& storage, const uint32_t solidTypes, const uint8_t singleType, FaceDirection faceDir, uint64_t slice, const ChunkColumns& columns, ChunkMeshScratch& scratch) const {
+		const uint64_t size = Chunk::CHUNK_SIZE >> m_lod;
+		uint64_t facePlane[Chunk::CHUNK_SIZE];
+		BuildFacePlane(faceDir, slice, size, columns, m_borders.solid[static_cast<uint32_t>(faceDir)], facePlane);
+
+		uint64_t anyFaces = 0;
+		for (uint64_t row = 0; row < Chunk::CHUNK_SIZE; row++) {
+			anyFaces |= facePlane[row];
+		}
+
+		if (anyFaces == 0)
+			return;
+
+		if (solidTypes == 1) {
+			scratch.quads.clear();
+			GreedyMeshBinaryPlane(&scratch.quads, facePlane);
+			for (const GreedyQuad& q : scratch.quads) {
+				AppendVertices(q, &scratch.vertices, faceDir, slice, singleType);
+			}
+			return;
+		}
+
+		uint32_t usedTypes = 0;
+		for (uint64_t row = 0; row < Chunk::CHUNK_SIZE; row++) {
+			uint64_t bits = facePlane[row];
+			while (bits != 0) {
+				uint64_t bit = trailing_zeroes(bits);
+				bits &= bits - 1;
+
+				// row/bit/slice back to chunk space, matching BuildFacePlane
+				uint16_t x, y, z;
+				switch (faceDir) {
+					case FaceDirection::down:
+					case FaceDirection::up:
+						x = row; y = slice; z = bit;
+						break;
+					case FaceDirection::left:
+					case FaceDirection::right:
+						x = slice; y = bit; z = row;
+						break;
+					default:
+						x = row; y = bit; z = slice;
+						break;
 				}
+
+				uint8_t type = m_lod == 0 ? storage.Get(Chunk::voxelIndex(x, y, z)) : scratch.lodTypes[x + (y + z * size) * size];
+				assert(type < VOXEL_TYPE_COUNT);
+				scratch.typePlanes[type][row] |= U_ONE << bit;
+				usedTypes |= 1u << type;
 			}
 		}
 
-		this->meshData = new Mesh();
-		const uint32_t size = vertices.size() * 3;
-		meshData->SetVertices(new float[size], size);
-		for (uint32_t i = 0; i < vertices.size(); i += 3) {
-			meshData->SetVertex(i, vertices.at(i).x);
-			meshData->SetVertex(i + 1, vertices.at(i).y);
-			meshData->SetVertex(i + 2, vertices.at(i).z);
+		while (usedTypes != 0) {
+			uint64_t type = trailing_zeroes(usedTypes);
+			usedTypes &= usedTypes - 1;
+
+			scratch.quads.clear();
+			GreedyMeshBinaryPlane(&scratch.quads, scratch.typePlanes[type]);
+			memset(scratch.typePlanes[type], 0, sizeof(scratch.typePlanes[type]));
+
+			for (const GreedyQuad& q : scratch.quads) {
+				AppendVertices(q, &scratch.vertices, faceDir, slice, static_cast<uint32_t>(type));
+			}
 		}
 	}
 
-	void ChunkMesh::ConstructAxisBitset(Chunk* chunkData, uint64_t*& outBitset) {
-		outBitset = new uint64_t[3 * CHUNK_SIZE_3]{ 0UL };
+	void ChunkMesh::ApplyEdit(const VoxelStorage& storage, const uint16_t x, const uint16_t y, const uint16_t z) {
+		assert(m_lod == 0);
+		if (m_columns == nullptr) {
+			// first edit, the columns are rebuilt from storage which already holds the new voxel
+			m_columns.reset(new ChunkColumns());
+			ConstructColumns(storage, *m_columns);
+		}
+		else {
+			const bool solid = storage.Get(Chunk::voxelIndex(x, y, z)) != AIR;
+			uint64_t& yColumn = m_columns->y[x + z * Chunk::CHUNK_SIZE];
+			uint64_t& zColumn = m_columns->z[x + y * Chunk::CHUNK_SIZE];
+			yColumn = solid ? (yColumn | (U_ONE << y)) : (yColumn & ~(U_ONE << y));
+			zColumn = solid ? (zColumn | (U_ONE << z)) : (zColumn & ~(U_ONE << z));
+		}
+
+		// the voxel's own faces, plus the faces of the six voxels around it that it may now hide or expose
+		uint32_t dirty[12];
+		uint32_t dirtyCount = 0;
+		auto markDirty = [&](FaceDirection dir, int32_t slice) {
+			if (slice >= 0 && slice < static_cast<int32_t>(Chunk::CHUNK_SIZE)) {
+				dirty[dirtyCount++] = static_cast<uint32_t>(dir) * Chunk::CHUNK_SIZE + slice;
+			}
+		};
+
+		markDirty(FaceDirection::up, y);
+		markDirty(FaceDirection::up, y - 1);
+		markDirty(FaceDirection::down, y);
+		markDirty(FaceDirection::down, y + 1);
+		markDirty(FaceDirection::right, x);
+		markDirty(FaceDirection::right, x - 1);
+		markDirty(FaceDirection::left, x);
+		markDirty(FaceDirection::left, x + 1);
+		markDirty(FaceDirection::back, z);
+		markDirty(FaceDirection::back, z - 1);
+		markDirty(FaceDirection::forward, z);
+		markDirty(FaceDirection::forward, z + 1);
+
+		RemeshSegments(storage, dirty, dirtyCount);
+	}
+
+	void ChunkMesh::ApplyBorderEdit(const VoxelStorage& storage, FaceDirection side, const uint16_t x, const uint16_t y, const uint16_t z, const bool solid) {
+		assert(m_lod == 0);
+		// same row/bit layout as ExtractBorder
+		uint16_t row, bit;
+		switch (side) {
+			case FaceDirection::down:
+			case FaceDirection::up:
+				row = x; bit = z;
+				break;
+			case FaceDirection::left:
+			case FaceDirection::right:
+				row = z; bit = y;
+				break;
+			default:
+				row = x; bit = y;
+				break;
+		}
+
+		uint64_t& border = m_borders.solid[static_cast<uint32_t>(side)][row];
+		border = solid ? (border | (U_ONE << bit)) : (border & ~(U_ONE << bit));
+
+		if (m_columns == nullptr) {
+			m_columns.reset(new ChunkColumns());
+			ConstructColumns(storage, *m_columns);
+		}
+
+		// only the boundary slice on that side looks at the border
+		const bool positive = side == FaceDirection::up || side == FaceDirection::right || side == FaceDirection::back;
+		uint32_t segment = static_cast<uint32_t>(side) * Chunk::CHUNK_SIZE + (positive ? Chunk::CHUNK_SIZE - 1 : 0);
+		RemeshSegments(storage, &segment, 1);
+	}
+
+	void ChunkMesh::RemeshSegments(const VoxelStorage& storage, uint32_t* dirty, const uint32_t dirtyCount) {
+		if (dirtyCount == 0)
+			return;
+
+		std::sort(dirty, dirty + dirtyCount);
 
-		for (uint64_t y = 0; y < Chunk::CHUNK_SIZE; y++) {
+		ChunkMeshScratch& scratch = GetScratch();
+		scratch.vertices.clear();
+
+		uint8_t singleType;
+		const uint32_t solidTypes = CountSolidTypes(storage, singleType);
+
+		// splice the new slices in between the untouched ones
+		uint32_t segmentStart[SEGMENT_COUNT + 1];
+		uint32_t next = 0;
+		for (uint32_t segment = 0; segment < SEGMENT_COUNT; segment++) {
+			segmentStart[segment] = static_cast<uint32_t>(scratch.vertices.size());
+
+			if (next < dirtyCount && dirty[next] == segment) {
+				while (next < dirtyCount && dirty[next] == segment) {
+					next++;
+				}
+
+				if (solidTypes > 0) {
+					const FaceDirection faceDir = static_cast<FaceDirection>(segment / Chunk::CHUNK_SIZE);
+					MeshSlice(storage, solidTypes, singleType, faceDir, segment % Chunk::CHUNK_SIZE, *m_columns, scratch);
+				}
+			}
+			else {
+				scratch.vertices.insert(scratch.vertices.end(), m_vertices.begin() + m_segmentStart[segment], m_vertices.begin() + m_segmentStart[segment + 1]);
+			}
+		}
+		segmentStart[SEGMENT_COUNT] = static_cast<uint32_t>(scratch.vertices.size());
+
+		m_vertices.assign(scratch.vertices.begin(), scratch.vertices.end());
+		memcpy(m_segmentStart, segmentStart, sizeof(m_segmentStart));
+		m_quadCount = static_cast<uint32_t>(m_vertices.size() / QuadIndexBuffer::VERTICES_PER_QUAD);
+
+		Reupload();
+	}
+
+	void ChunkMesh::Reupload() {
+		// not uploaded yet, Upload() will send the whole thing
+		if (!m_uploaded)
+			return;
+
+		// the GPU may still be drawing the old range, so rather than patching it the vertices go to a fresh one
+		QuadIndexBuffer::EnsureCapacity(m_quadCount);
+		m_arenaHandle = ChunkArena::Reallocate(m_arenaHandle, m_vertices.data(), static_cast<uint32_t>(m_vertices.size()));
+	}
+
+	ChunkMesh::~ChunkMesh() {
+		ChunkArena::Free(m_arenaHandle);
+		m_arenaHandle = ChunkArena::INVALID_HANDLE;
+	}
+
+	void ChunkMesh::Upload() {
+		if (m_uploaded)
+			return;
+
+		// empty meshes take no space in the arena but still count as uploaded, so later edits upload themselves
+		QuadIndexBuffer::EnsureCapacity(m_quadCount);
+		m_arenaHandle = ChunkArena::Allocate(m_vertices.data(), static_cast<uint32_t>(m_vertices.size()));
+		m_uploaded = true;
+	}
+
+	void ChunkMesh::Draw(const vec3f& chunkCoords) const {
+		if (!m_uploaded || m_quadCount == 0)
+			return;
+
+		ChunkArena::AddDraw(m_arenaHandle, m_quadCount, chunkCoords, static_cast<float>(1u << m_lod));
+	}
+
+	uint64_t ChunkMesh::MemoryUsage() const {
+		return sizeof(ChunkMesh) + m_vertices.capacity() * sizeof(VoxelVertex) + (m_columns != nullptr ? sizeof(ChunkColumns) : 0);
+	}
+
+	void ChunkMesh::ConstructColumns(const VoxelStorage& storage, ChunkColumns& outColumns) {
+		if (Chunk::LAYOUT == Chunk::Layout::linear) {
+			// one solid bit per voxel straight from the packed storage, so each word is the x row at y + z * size
+			static thread_local uint64_t rows[CHUNK_SIZE_2];
+			storage.NotEqualMask(AIR, rows);
+
+			// the 64 rows of a z layer, one per y, transpose into that layer's y columns, one per x
 			for (uint64_t z = 0; z < Chunk::CHUNK_SIZE; z++) {
-				for (uint64_t x = 0; x < Chunk::CHUNK_SIZE; x++) {
-					voxel* const v = chunkData->getVoxel(x, y, z);
-					if (v->type != AIR) {
-						// xz - y axis
-						outBitset[x + (z * Chunk::CHUNK_SIZE)] |= U_ONE << y;
-						// zy - x axis
-						outBitset[z + (y * Chunk::CHUNK_SIZE) + CHUNK_SIZE_2] |= U_ONE << x;
-						// xy - z axis
-						outBitset[x + (y * Chunk::CHUNK_SIZE) + CHUNK_SIZE_2 * 2] |= U_ONE << z;
+				uint64_t* columns = outColumns.y + z * Chunk::CHUNK_SIZE;
+				memcpy(columns, rows + z * Chunk::CHUNK_SIZE, Chunk::CHUNK_SIZE * sizeof(uint64_t));
+				transpose_64x64(columns);
+			}
+
+			// likewise the rows of a y layer, one per z, give its z columns
+			for (uint64_t y = 0; y < Chunk::CHUNK_SIZE; y++) {
+				uint64_t* columns = outColumns.z + y * Chunk::CHUNK_SIZE;
+				for (uint64_t z = 0; z < Chunk::CHUNK_SIZE; z++) {
+					columns[z] = rows[y + z * Chunk::CHUNK_SIZE];
+				}
+				transpose_64x64(columns);
+			}
+			return;
+		}
+
+		memset(&outColumns, 0, sizeof(ChunkColumns));
+
+		// walks the storage in index order
+		Chunk::forEachVoxel([&](uint32_t index, uint16_t x, uint16_t y, uint16_t z) {
+			if (storage.Get(index) != AIR) {
+				outColumns.y[x + (z * Chunk::CHUNK_SIZE)] |= U_ONE << y;
+				outColumns.z[x + (y * Chunk::CHUNK_SIZE)] |= U_ONE << z;
+			}
+		});
+	}
+
+	void ChunkMesh::ExtractBorder(const VoxelStorage& neighbour, FaceDirection side, uint64_t* outPlane) {
+		if (neighbour.IsUniform()) {
+			const uint64_t fill = neighbour.Palette()[0] != AIR ? ~0ull : 0;
+			for (uint64_t row = 0; row < Chunk::CHUNK_SIZE; row++) {
+				outPlane[row] = fill;
+			}
+			return;
+		}
+
+		// the neighbour's slice facing us, e.g. the chunk above contributes its y = 0 layer
+		const uint16_t last = Chunk::CHUNK_SIZE - 1;
+		for (uint16_t row = 0; row < Chunk::CHUNK_SIZE; row++) {
+			uint64_t bits = 0;
+			for (uint16_t bit = 0; bit < Chunk::CHUNK_SIZE; bit++) {
+				uint32_t index;
+				switch (side) {
+					// rows along x, bits along z
+					case FaceDirection::up:
+						index = Chunk::voxelIndex(row, 0, bit);
+						break;
+					case FaceDirection::down:
+						index = Chunk::voxelIndex(row, last, bit);
+						break;
+					// rows along z, bits along y
+					case FaceDirection::right:
+						index = Chunk::voxelIndex(0, bit, row);
+						break;
+					case FaceDirection::left:
+						index = Chunk::voxelIndex(last, bit, row);
+						break;
+					// rows along x, bits along y
+					case FaceDirection::back:
+						index = Chunk::voxelIndex(row, bit, 0);
+						break;
+					default:
+						index = Chunk::voxelIndex(row, bit, last);
+						break;
+				}
+
+				if (neighbour.Get(index) != AIR) {
+					bits |= U_ONE << bit;
+				}
+			}
+			outPlane[row] = bits;
+		}
+	}
+
+	uint32_t ChunkMesh::Downsample(const VoxelStorage& storage, const uint32_t lod, ChunkColumns& outColumns, uint8_t* outTypes) {
+		const uint64_t factor = U_ONE << lod;
+		const uint64_t size = Chunk::CHUNK_SIZE >> lod;
+		const uint64_t cellMask = (U_ONE << factor) - 1;
+		static thread_local uint64_t rows[CHUNK_SIZE_2];
+		Chunk::solidRows(storage, rows);
+		memset(&outColumns, 0, sizeof(ChunkColumns));
+
+		uint32_t usedTypes = 0;
+		for (uint64_t cellZ = 0; cellZ < size; cellZ++) {
+			for (uint64_t cellY = 0; cellY < size; cellY++) {
+				// every x row running through this line of cells, folded into one
+				uint64_t any = 0;
+				for (uint64_t z = cellZ * factor; z < (cellZ + 1) * factor; z++) {
+					for (uint64_t y = cellY * factor; y < (cellY + 1) * factor; y++) {
+						any |= rows[y + z * Chunk::CHUNK_SIZE];
+					}
+				}
+
+				for (uint64_t cellX = 0; cellX < size; cellX++) {
+					const uint64_t xMask = cellMask << (cellX * factor);
+					uint8_t type = AIR;
+					if ((any & xMask) != 0) {
+						// the topmost solid voxel picks the type, so grass stays on top of distant hills
+						for (uint64_t y = (cellY + 1) * factor; type == AIR && y-- > cellY * factor;) {
+							for (uint64_t z = cellZ * factor; z < (cellZ + 1) * factor; z++) {
+								const uint64_t bits = rows[y + z * Chunk::CHUNK_SIZE] & xMask;
+								if (bits != 0) {
+									type = storage.Get(Chunk::voxelIndex(static_cast<uint16_t>(trailing_zeroes(bits)), static_cast<uint16_t>(y), static_cast<uint16_t>(z)));
+									break;
+								}
+							}
+						}
+					}
+
+					outTypes[cellX + (cellY + cellZ * size) * size] = type;
+					if (type != AIR) {
+						outColumns.y[cellX + cellZ * Chunk::CHUNK_SIZE] |= U_ONE << cellY;
+						outColumns.z[cellX + cellY * Chunk::CHUNK_SIZE] |= U_ONE << cellZ;
+						usedTypes |= 1u << type;
 					}
 				}
 			}
 		}
+
+		return usedTypes;
+	}
+
+	void ChunkMesh::DownsampleBorder(const uint64_t* plane, const uint32_t lod, uint64_t* outPlane) {
+		const uint64_t factor = U_ONE << lod;
+		const uint64_t size = Chunk::CHUNK_SIZE >> lod;
+		const uint64_t cellMask = (U_ONE << factor) - 1;
+
+		for (uint64_t row = 0; row < Chunk::CHUNK_SIZE; row++) {
+			outPlane[row] = 0;
+			if (row >= size)
+				continue;
+
+			uint64_t all = ~0ull;
+			for (uint64_t i = 0; i < factor; i++) {
+				all &= plane[row * factor + i];
+			}
+
+			for (uint64_t bit = 0; bit < size; bit++) {
+				if (((all >> (bit * factor)) & cellMask) == cellMask) {
+					outPlane[row] |= U_ONE << bit;
+				}
+			}
+		}
+	}
+
+	void ChunkMesh::BuildFacePlane(FaceDirection dir, uint64_t slice, const uint64_t size, const ChunkColumns& columns, const uint64_t* border, uint64_t* outPlane) {
+		// a face is visible where the voxel is solid and its neighbour in the face direction is not.
+		// on the chunk boundary the neighbour comes from the border plane (zeroed, i.e. air, without a neighbour).
+		const bool hasNext = slice + 1 < size;
+		const bool hasPrev = slice > 0;
+		const uint64_t* yColumns = columns.y;
+		const uint64_t* zColumns = columns.z;
+
+		for (uint64_t row = 0; row < Chunk::CHUNK_SIZE; row++) {
+			const uint64_t outside = border[row];
+			switch (dir) {
+				// rows along x, bits along z
+				case FaceDirection::up:
+					outPlane[row] = zColumns[row + slice * Chunk::CHUNK_SIZE] & ~(hasNext ? zColumns[row + (slice + 1) * Chunk::CHUNK_SIZE] : outside);
+					break;
+				case FaceDirection::down:
+					outPlane[row] = zColumns[row + slice * Chunk::CHUNK_SIZE] & ~(hasPrev ? zColumns[row + (slice - 1) * Chunk::CHUNK_SIZE] : outside);
+					break;
+				// rows along z, bits along y
+				case FaceDirection::right:
+					outPlane[row] = yColumns[slice + row * Chunk::CHUNK_SIZE] & ~(hasNext ? yColumns[slice + 1 + row * Chunk::CHUNK_SIZE] : outside);
+					break;
+				case FaceDirection::left:
+					outPlane[row] = yColumns[slice + row * Chunk::CHUNK_SIZE] & ~(hasPrev ? yColumns[slice - 1 + row * Chunk::CHUNK_SIZE] : outside);
+					break;
+				// rows along x, bits along y
+				case FaceDirection::back:
+					outPlane[row] = yColumns[row + slice * Chunk::CHUNK_SIZE] & ~(hasNext ? yColumns[row + (slice + 1) * Chunk::CHUNK_SIZE] : outside);
+					break;
+				case FaceDirection::forward:
+					outPlane[row] = yColumns[row + slice * Chunk::CHUNK_SIZE] & ~(hasPrev ? yColumns[row + (slice - 1) * Chunk::CHUNK_SIZE] : outside);
+					break;
+			}
+		}
 	}
 
 	void ChunkMesh::GreedyMeshBinaryPlane(std::vector<GreedyQuad>* quadVertices, uint64_t* planeData) {
@@ -176,28 +602,44 @@ namespace sogl {
 		}
 	}
 
-	vec3f ChunkMesh::WorldToSample(FaceDirection dir, uint64_t axis, uint64_t x, uint64_t y) {
+	VoxelVertex ChunkMesh::WorldToSample(FaceDirection dir, uint64_t axis, uint64_t x, uint64_t y, uint32_t blockType) {
+		const uint32_t normal = NormalIndex(dir);
 		switch (dir) {
 			case FaceDirection::up:
-				return vec3f(x, axis + 1, y);
+				return PackVoxelVertex(x, axis + 1, y, normal, blockType);
 			case FaceDirection::down:
-				return vec3f(x, axis, y);
+				return PackVoxelVertex(x, axis, y, normal, blockType);
 			case FaceDirection::left:
-				return vec3f(axis, y, x);
+				return PackVoxelVertex(axis, y, x, normal, blockType);
 			case FaceDirection::right:
-				return vec3f(axis + 1, y, x);
+				return PackVoxelVertex(axis + 1, y, x, normal, blockType);
 			case FaceDirection::forward:
-				return vec3f(x, y, axis);
-			case FaceDirection::back:
-				return vec3f(x, y, axis + 1);
+				return PackVoxelVertex(x, y, axis, normal, blockType);
+			default:
+				return PackVoxelVertex(x, y, axis + 1, normal, blockType);
 		}
 	}
 
-	void ChunkMesh::AppendVertices(GreedyQuad quad, std::vector<vec3f>* vertices, std::vector<uint32_t>* normals, FaceDirection faceDir, uint64_t axis, uint64_t blockType) {
-		vertices->push_back(WorldToSample(faceDir, axis, quad.x, quad.y));
-		vertices->push_back(WorldToSample(faceDir, axis, quad.x + quad.w, quad.y + quad.h));
-		vertices->push_back(WorldToSample(faceDir, axis, quad.x, quad.y + quad.h));
-		vertices->push_back(WorldToSample(faceDir, axis, quad.x + quad.w, quad.y));
-		normals->push_back(NormalIndex(faceDir));
+	void ChunkMesh::AppendVertices(const GreedyQuad& quad, std::vector<VoxelVertex>* vertices, FaceDirection faceDir, uint64_t axis, uint32_t blockType) {
+		VoxelVertex corners[4] = {
+			WorldToSample(faceDir, axis, quad.x, quad.y, blockType),
+			WorldToSample(faceDir, axis, quad.x + quad.w, quad.y, blockType),
+			WorldToSample(faceDir, axis, quad.x + quad.w, quad.y + quad.h, blockType),
+			WorldToSample(faceDir, axis, quad.x, quad.y + quad.h, blockType)
+		};
+
+		// corners go counter-clockwise when seen from outside, so they survive back-face culling
+		if (ReverseOrder(faceDir)) {
+			vertices->push_back(corners[0]);
+			vertices->push_back(corners[3]);
+			vertices->push_back(corners[2]);
+			vertices->push_back(corners[1]);
+		}
+		else {
+			vertices->push_back(corners[0]);
+			vertices->push_back(corners[1]);
+			vertices->push_back(corners[2]);
+			vertices->push_back(corners[3]);
+		}
 	}
 }
\ No newline at end of file
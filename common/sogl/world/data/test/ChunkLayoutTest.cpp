@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <vector>
+
+#include <sogl/test/Test.h>
+#include <sogl/world/data/chunk.h>
+#include <sogl/world/data/chunkMesh.h>
+#include <sogl/world/generation/TerrainGenerator.h>
+
+using namespace sogl;
+
+SOGL_TEST(ChunkLayout_IndexRoundTrip) {
+	bool same = true;
+	for (uint32_t i = 0; i < ChunkSummary::VOXELS; i++) {
+		uint16_t x;
+		uint16_t y;
+		uint16_t z;
+		Chunk::voxelCoords(i, x, y, z);
+		same = same && x < 64 && y < 64 && z < 64 && Chunk::voxelIndex(x, y, z) == i;
+	}
+	SOGL_CHECK(same);
+}
+
+SOGL_TEST(ChunkLayout_ForEachVoxelWalksStorageOrder) {
+	uint32_t expected = 0;
+	bool inOrder = true;
+	Chunk::forEachVoxel([&](const uint32_t index, const uint16_t x, const uint16_t y, const uint16_t z) {
+		inOrder = inOrder && index == expected++ && Chunk::voxelIndex(x, y, z) == index;
+	});
+	SOGL_CHECK(inOrder);
+	SOGL_CHECK(expected == ChunkSummary::VOXELS);
+}
+
+SOGL_TEST(ChunkLayout_SolidRowsMatchVoxels) {
+	TerrainSettings settings;
+	settings.mode = TerrainMode::density;
+	const TerrainGenerator generator(settings);
+	const Chunk chunk(vec3f(0.0f, 0.0f, 0.0f), generator);
+
+	std::vector<uint64_t> rows(64 * 64);
+	Chunk::solidRows(chunk.getStorage(), rows.data());
+
+	bool same = true;
+	for (uint16_t z = 0; z < 64; z++) {
+		for (uint16_t y = 0; y < 64; y++) {
+			for (uint16_t x = 0; x < 64; x++) {
+				same = same && ((rows[y + z * 64] >> x) & 1) == (chunk.getVoxel(x, y, z).type != AIR);
+			}
+		}
+	}
+	SOGL_CHECK(same);
+}
+
+// Build once as is and once with SOGL_CHUNK_LAYOUT_MORTON defined to compare the two layouts.
+SOGL_BENCHMARK(ChunkLayout_GenerateMeshEdit) {
+	const TerrainGenerator heightmap;
+	TerrainSettings densitySettings;
+	densitySettings.mode = TerrainMode::density;
+	const TerrainGenerator density(densitySettings);
+
+	uint32_t chunkIndex = 0;
+	const double generateHeightmap = test::BestOf(20, [&]() {
+		const Chunk chunk(vec3f(64.0f * chunkIndex++, -64.0f, 0.0f), heightmap);
+		test::DoNotOptimize(&chunk);
+	});
+	const double generateDensity = test::BestOf(20, [&]() {
+		const Chunk chunk(vec3f(64.0f * chunkIndex++, 0.0f, 0.0f), density);
+		test::DoNotOptimize(&chunk);
+	});
+
+	Chunk chunk(vec3f(0.0f, 0.0f, 0.0f), density);
+	std::vector<uint64_t> rows(64 * 64);
+	const double solidRows = test::BestOf(50, [&]() {
+		Chunk::solidRows(chunk.getStorage(), rows.data());
+		test::DoNotOptimize(rows.data());
+	});
+	const double mesh = test::BestOf(20, [&]() {
+		const ChunkMesh chunkMesh(chunk.getStorage());
+		test::DoNotOptimize(&chunkMesh);
+	});
+
+	ChunkMesh chunkMesh(chunk.getStorage());
+	uint32_t round = 0;
+	const double edits = test::BestOf(10, [&]() {
+		for (uint32_t i = 0; i < 200; i++) {
+			const uint16_t x = (i * 37 + round) % 64;
+			const uint16_t y = (i * 11) % 64;
+			const uint16_t z = (i * 53) % 64;
+			chunk.setVoxel(x, y, z, i % 2 ? AIR : STONE);
+			chunkMesh.ApplyEdit(chunk.getStorage(), x, y, z);
+		}
+		round++;
+	});
+
+	printf("  %s layout\n", Chunk::LAYOUT == Chunk::Layout::morton ? "morton" : "linear");
+	printf("  generate: heightmap %.0f us, density %.0f us\n", generateHeightmap, generateDensity);
+	printf("  solid rows %.1f us, full mesh %.0f us, 200 edits %.0f us\n", solidRows, mesh, edits);
+}
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include <sogl/bitmanip.hpp>
+#include <sogl/test/Test.h>
+#include <sogl/world/data/chunk.h>
+#include <sogl/world/data/chunkMesh.h>
+
+using namespace sogl;
+
+// (NormalIndex, x, y, z) of the voxel a face belongs to
+typedef std::tuple<uint32_t, uint32_t, uint32_t, uint32_t> Face;
+
+// step from a voxel to the one in front of each face, indexed by NormalIndex: -x, +x, -y, +y, -z, +z
+static const int NORMAL_STEP[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+
+enum class Pattern {
+	// every third voxel solid, in one of four types
+	noise,
+	// stone and dirt under a bumpy surface
+	terrain,
+	// 8x8x8 blocks alternating between air and a mix of two types, lots of small quads
+	checkerboard
+};
+
+static VoxelStorage MakeVoxels(const Pattern pattern, const uint32_t seed) {
+	std::mt19937 random(seed);
+	VoxelStorage voxels(ChunkSummary::VOXELS, AIR);
+	Chunk::forEachVoxel([&](const uint32_t index, const uint16_t x, const uint16_t y, const uint16_t z) {
+		uint8_t type = AIR;
+		switch (pattern) {
+			case Pattern::noise:
+				type = random() % 3 == 0 ? static_cast<uint8_t>(1 + random() % 4) : static_cast<uint8_t>(AIR);
+				break;
+			case Pattern::terrain:
+				type = y < 24 + (x / 8 + z / 8) % 5 ? (y < 18 ? STONE : DIRT) : AIR;
+				break;
+			case Pattern::checkerboard:
+				type = (x / 8 + y / 8 + z / 8) % 2 ? (random() % 2 ? DIRT : STONE) : AIR;
+				break;
+		}
+		voxels.Set(index, type);
+	});
+
+	return voxels;
+}
+
+static uint8_t TypeAt(const VoxelStorage& voxels, const int x, const int y, const int z) {
+	if (x < 0 || y < 0 || z < 0 || x >= 64 || y >= 64 || z >= 64)
+		return AIR;
+
+	return voxels.Get(Chunk::voxelIndex(x, y, z));
+}
+
+// Every face of a solid voxel with air, or the right neighbour's air, in front of it.
+static std::set<Face> BruteForceFaces(const VoxelStorage& voxels, const VoxelStorage* rightNeighbour) {
+	std::set<Face> faces;
+	for (int z = 0; z < 64; z++) {
+		for (int y = 0; y < 64; y++) {
+			for (int x = 0; x < 64; x++) {
+				if (TypeAt(voxels, x, y, z) == AIR)
+					continue;
+
+				for (uint32_t normal = 0; normal < 6; normal++) {
+					const int nx = x + NORMAL_STEP[normal][0];
+					const int ny = y + NORMAL_STEP[normal][1];
+					const int nz = z + NORMAL_STEP[normal][2];
+					const bool covered = nx == 64 && rightNeighbour != nullptr ? TypeAt(*rightNeighbour, 0, ny, nz) != AIR : TypeAt(voxels, nx, ny, nz) != AIR;
+					if (!covered) {
+						faces.emplace(normal, x, y, z);
+					}
+				}
+			}
+		}
+	}
+
+	return faces;
+}
+
+// Rasterizes the mesh's quads back into unit faces. Fails the test if a quad covers a face twice or covers voxels
+// of a different type than its own.
+static std::set<Face> MeshFaces(const ChunkMesh& mesh, const VoxelStorage& voxels) {
+	std::set<Face> faces;
+	const std::vector<VoxelVertex>& vertices = mesh.Vertices();
+	SOGL_CHECK(vertices.size() == mesh.QuadCount() * 4);
+
+	uint32_t duplicates = 0;
+	uint32_t wrongTypes = 0;
+	for (size_t quad = 0; quad + 3 < vertices.size(); quad += 4) {
+		uint32_t low[3] = { 64, 64, 64 };
+		uint32_t high[3] = { 0, 0, 0 };
+		for (size_t corner = quad; corner < quad + 4; corner++) {
+			const uint32_t position[3] = { VoxelVertexX(vertices[corner]), VoxelVertexY(vertices[corner]), VoxelVertexZ(vertices[corner]) };
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				low[axis] = position[axis] < low[axis] ? position[axis] : low[axis];
+				high[axis] = position[axis] > high[axis] ? position[axis] : high[axis];
+			}
+		}
+
+		// the quad lies in the plane between the voxel and the one in front of it
+		const uint32_t normal = VoxelVertexNormal(vertices[quad]);
+		const uint32_t type = VoxelVertexType(vertices[quad]);
+		const uint32_t planeAxis = normal / 2;
+		const bool positive = normal % 2 == 1;
+		high[planeAxis] = low[planeAxis] + 1;
+		if (positive) {
+			low[planeAxis]--;
+			high[planeAxis]--;
+		}
+
+		for (uint32_t z = low[2]; z < high[2]; z++) {
+			for (uint32_t y = low[1]; y < high[1]; y++) {
+				for (uint32_t x = low[0]; x < high[0]; x++) {
+					if (!faces.emplace(normal, x, y, z).second) {
+						duplicates++;
+					}
+					if (TypeAt(voxels, x, y, z) != type) {
+						wrongTypes++;
+					}
+				}
+			}
+		}
+	}
+
+	SOGL_CHECK(duplicates == 0);
+	SOGL_CHECK(wrongTypes == 0);
+	return faces;
+}
+
+SOGL_TEST(ChunkMesh_MatchesBruteForceFaces) {
+	const Pattern patterns[] = { Pattern::noise, Pattern::terrain, Pattern::checkerboard };
+	for (const Pattern pattern : patterns) {
+		const VoxelStorage voxels = MakeVoxels(pattern, 5);
+		const ChunkMesh mesh(voxels);
+		SOGL_CHECK(MeshFaces(mesh, voxels) == BruteForceFaces(voxels, nullptr));
+	}
+}
+
+// the column bitsets are built straight from the packed indices, which are read differently at each width
+SOGL_TEST(ChunkMesh_EveryPaletteWidth) {
+	std::vector<VoxelStorage> chunks;
+	chunks.push_back(VoxelStorage(ChunkSummary::VOXELS, STONE));
+	chunks.push_back(MakeVoxels(Pattern::noise, 14));
+	// air and stone only
+	for (uint32_t i = 0; i < ChunkSummary::VOXELS; i++) {
+		if (chunks.back().Get(i) != AIR) {
+			chunks.back().Set(i, STONE);
+		}
+	}
+	chunks.back().Compact();
+	chunks.push_back(MakeVoxels(Pattern::terrain, 15));
+	chunks.push_back(MakeVoxels(Pattern::noise, 16));
+	// grow the palette past 16 entries, then put real types back, so the 8 bit indices stay
+	chunks.push_back(MakeVoxels(Pattern::noise, 17));
+	for (uint8_t i = 0; i < 20; i++) {
+		chunks.back().Set(i, static_cast<uint8_t>(100 + i));
+		chunks.back().Set(i, static_cast<uint8_t>(i % VOXEL_TYPE_COUNT));
+	}
+
+	const uint8_t widths[] = { 0, 1, 2, 4, 8 };
+	for (uint32_t i = 0; i < chunks.size(); i++) {
+		SOGL_CHECK(chunks[i].BitsPerIndex() == widths[i]);
+		const ChunkMesh mesh(chunks[i]);
+		SOGL_CHECK(MeshFaces(mesh, chunks[i]) == BruteForceFaces(chunks[i], nullptr));
+	}
+}
+
+SOGL_TEST(ChunkMesh_CullsAgainstBorders) {
+	const VoxelStorage voxels = MakeVoxels(Pattern::noise, 6);
+	const VoxelStorage neighbour = MakeVoxels(Pattern::noise, 7);
+
+	ChunkBorders borders;
+	ChunkMesh::ExtractBorder(neighbour, FaceDirection::right, borders.solid[static_cast<uint32_t>(FaceDirection::right)]);
+	const ChunkMesh mesh(voxels, &borders);
+	SOGL_CHECK(MeshFaces(mesh, voxels) == BruteForceFaces(voxels, &neighbour));
+}
+
+SOGL_TEST(ChunkMesh_EditMatchesRemesh) {
+	VoxelStorage voxels = MakeVoxels(Pattern::terrain, 8);
+	ChunkMesh mesh(voxels);
+
+	std::mt19937 random(9);
+	for (uint32_t i = 0; i < 64; i++) {
+		const uint16_t x = random() % 64;
+		const uint16_t y = 16 + random() % 16;
+		const uint16_t z = random() % 64;
+		voxels.Set(Chunk::voxelIndex(x, y, z), i % 2 ? AIR : COBBLESTONE);
+		mesh.ApplyEdit(voxels, x, y, z);
+	}
+
+	SOGL_CHECK(MeshFaces(mesh, voxels) == BruteForceFaces(voxels, nullptr));
+}
+
+SOGL_BENCHMARK(ChunkMesh_ChunksPerSecond) {
+	const Pattern patterns[] = { Pattern::noise, Pattern::terrain, Pattern::checkerboard };
+	const char* names[] = { "noise", "terrain", "checkerboard" };
+	for (uint32_t i = 0; i < 3; i++) {
+		const VoxelStorage voxels = MakeVoxels(patterns[i], 10);
+		uint32_t quads = 0;
+		const double us = test::BestOf(20, [&]() {
+			const ChunkMesh mesh(voxels);
+			quads = mesh.QuadCount();
+		});
+		printf("  %-12s %8.1f us, %8.0f chunks/s, %u quads\n", names[i], us, 1e6 / us, quads);
+	}
+}
+
+// the column bitsets ChunkMesh builds from, one solid bit per voxel along y and along z
+SOGL_BENCHMARK(ChunkMesh_ColumnBitsets) {
+	const VoxelStorage voxels = MakeVoxels(Pattern::terrain, 11);
+	std::vector<uint64_t> yColumns(64 * 64);
+	std::vector<uint64_t> zColumns(64 * 64);
+	std::vector<uint64_t> rows(64 * 64);
+
+	// the per-voxel scatter the mesher used to do
+	const double scatter = test::BestOf(50, [&]() {
+		memset(yColumns.data(), 0, yColumns.size() * sizeof(uint64_t));
+		memset(zColumns.data(), 0, zColumns.size() * sizeof(uint64_t));
+		Chunk::forEachVoxel([&](const uint32_t index, const uint16_t x, const uint16_t y, const uint16_t z) {
+			if (voxels.Get(index) != AIR) {
+				yColumns[x + z * 64] |= 1ull << y;
+				zColumns[x + y * 64] |= 1ull << z;
+			}
+		});
+		test::DoNotOptimize(yColumns.data());
+	});
+
+	// the same steps as ChunkMesh::ConstructColumns: a solid mask from the packed indices, then a transpose per layer
+	const double transposed = test::BestOf(50, [&]() {
+		Chunk::solidRows(voxels, rows.data());
+		for (uint32_t z = 0; z < 64; z++) {
+			memcpy(yColumns.data() + z * 64, rows.data() + z * 64, 64 * sizeof(uint64_t));
+			transpose_64x64(yColumns.data() + z * 64);
+		}
+		for (uint32_t y = 0; y < 64; y++) {
+			for (uint32_t z = 0; z < 64; z++) {
+				zColumns[y * 64 + z] = rows[y + z * 64];
+			}
+			transpose_64x64(zColumns.data() + y * 64);
+		}
+		test::DoNotOptimize(yColumns.data());
+	});
+
+	printf("  per-voxel scatter %.1f us, mask and transposes %.1f us\n", scatter, transposed);
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include <string.h>
+#include <random>
+
+#include <sogl/test/Test.h>
+#include <sogl/world/data/chunk.h>
+
+using namespace sogl;
+
+static bool SameSummary(const ChunkSummary& a, const ChunkSummary& b) {
+	return a.solidCount == b.solidCount
+		&& memcmp(a.faceSolidCount, b.faceSolidCount, sizeof(a.faceSolidCount)) == 0
+		&& memcmp(a.faceConnections, b.faceConnections, sizeof(a.faceConnections)) == 0;
+}
+
+// A chunk split by a solid wall at x = 32, with a hole through it at (32, 10, 10).
+static VoxelStorage Wall() {
+	VoxelStorage voxels(ChunkSummary::VOXELS, AIR);
+	for (uint16_t z = 0; z < 64; z++) {
+		for (uint16_t y = 0; y < 64; y++) {
+			voxels.Set(Chunk::voxelIndex(32, y, z), STONE);
+		}
+	}
+	voxels.Set(Chunk::voxelIndex(32, 10, 10), AIR);
+	return voxels;
+}
+
+SOGL_TEST(ChunkSummary_EditsMatchFreshSummary) {
+	Chunk chunk(vec3f(0.0f, 0.0f, 0.0f), Wall());
+	SOGL_CHECK(chunk.getSummary().CanSeeThrough(FaceDirection::left, FaceDirection::right));
+
+	// closing the hole splits the chunk, but only once the connections are refreshed
+	chunk.setVoxel(32, 10, 10, STONE);
+	SOGL_CHECK(chunk.getSummary().solidCount == 64 * 64);
+	chunk.refreshConnections();
+	SOGL_CHECK(!chunk.getSummary().CanSeeThrough(FaceDirection::left, FaceDirection::right));
+	SOGL_CHECK(chunk.getSummary().CanSeeThrough(FaceDirection::left, FaceDirection::up));
+
+	// a burst of random edits ends up where summarizing the voxels from scratch does
+	std::mt19937 random(22);
+	for (uint32_t i = 0; i < 5000; i++) {
+		chunk.setVoxel(random() % 64, random() % 64, random() % 64, random() % 2 ? AIR : DIRT);
+	}
+	chunk.refreshConnections();
+	const Chunk fresh(vec3f(0.0f, 0.0f, 0.0f), chunk.getStorage());
+	SOGL_CHECK(SameSummary(chunk.getSummary(), fresh.getSummary()));
+
+	// emptied by edits
+	Chunk single(vec3f(0.0f, 0.0f, 0.0f), VoxelStorage(ChunkSummary::VOXELS, AIR));
+	single.setVoxel(5, 5, 5, STONE);
+	single.refreshConnections();
+	single.setVoxel(5, 5, 5, AIR);
+	single.refreshConnections();
+	SOGL_CHECK(single.getSummary().IsEmpty());
+	SOGL_CHECK(single.getSummary().faceConnections[0] == 0x3F);
+}
\ No newline at end of file
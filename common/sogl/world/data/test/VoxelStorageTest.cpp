@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+#include <sogl/test/Fixtures.h>
+#include <sogl/test/Test.h>
+#include <sogl/world/data/VoxelStorage.h>
+
+using namespace sogl;
+
+SOGL_TEST(VoxelStorage_SetGetMatchesFlatArray) {
+	std::mt19937 random(3);
+	std::vector<uint8_t> reference(ChunkSummary::VOXELS, 0);
+	VoxelStorage storage(ChunkSummary::VOXELS, 0);
+
+	// the palette grows through every index width on the way
+	for (uint32_t i = 0; i < 200000; i++) {
+		const uint32_t types = i < 50000 ? 2 : (i < 100000 ? 5 : 200);
+		const uint32_t index = random() % ChunkSummary::VOXELS;
+		const uint8_t value = static_cast<uint8_t>(random() % types);
+		storage.Set(index, value);
+		reference[index] = value;
+	}
+
+	bool same = true;
+	for (uint32_t i = 0; i < ChunkSummary::VOXELS && same; i++) {
+		same = storage.Get(i) == reference[i];
+	}
+	SOGL_CHECK(same);
+
+	std::vector<uint8_t> unpacked(ChunkSummary::VOXELS);
+	storage.Unpack(unpacked.data());
+	SOGL_CHECK(unpacked == reference);
+
+	storage.Compact();
+	storage.Unpack(unpacked.data());
+	SOGL_CHECK(unpacked == reference);
+}
+
+SOGL_TEST(VoxelStorage_PackPicksSmallestWidth) {
+	VoxelStorage uniform(ChunkSummary::VOXELS, 3);
+	SOGL_CHECK(uniform.IsUniform());
+	SOGL_CHECK(uniform.Get(ChunkSummary::VOXELS - 1) == 3);
+
+	const std::vector<uint8_t> terrain = test::TerrainVoxels();
+	VoxelStorage storage;
+	storage.Pack(terrain.data(), ChunkSummary::VOXELS);
+	SOGL_CHECK(storage.BitsPerIndex() == 2);
+	SOGL_CHECK(storage.MemoryUsage() < ChunkSummary::VOXELS / 4 + 64);
+
+	std::vector<uint8_t> unpacked(ChunkSummary::VOXELS);
+	storage.Unpack(unpacked.data());
+	SOGL_CHECK(unpacked == terrain);
+
+	// back to a single value once the other entries are gone
+	storage.Fill(0);
+	SOGL_CHECK(storage.IsUniform());
+}
+
+SOGL_TEST(VoxelStorage_CompactDropsUnusedEntries) {
+	VoxelStorage storage(ChunkSummary::VOXELS, 0);
+	for (uint8_t value = 1; value < 20; value++) {
+		storage.Set(value, value);
+	}
+	SOGL_CHECK(storage.BitsPerIndex() == 8);
+
+	for (uint8_t value = 3; value < 20; value++) {
+		storage.Set(value, 0);
+	}
+	storage.Compact();
+	SOGL_CHECK(storage.BitsPerIndex() == 2);
+	SOGL_CHECK(storage.Get(1) == 1 && storage.Get(2) == 2 && storage.Get(3) == 0);
+}
+
+SOGL_TEST(VoxelStorage_NotEqualMask) {
+	std::mt19937 random(4);
+	// every index width, and a size that ends partway through a word
+	const uint32_t types[] = { 1, 2, 3, 16, 200 };
+	const uint32_t sizes[] = { ChunkSummary::VOXELS, 1000 };
+	for (const uint32_t size : sizes) {
+		for (const uint32_t typeCount : types) {
+			std::vector<uint8_t> values(size);
+			for (uint8_t& value : values) {
+				value = random() % 4 == 0 ? 0 : static_cast<uint8_t>(random() % typeCount);
+			}
+
+			VoxelStorage storage;
+			storage.Pack(values.data(), size);
+
+			std::vector<uint64_t> bits((size + 63) / 64);
+			storage.NotEqualMask(0, bits.data());
+
+			bool same = true;
+			for (uint32_t i = 0; i < size && same; i++) {
+				same = ((bits[i / 64] >> (i % 64)) & 1) == (values[i] != 0);
+			}
+			SOGL_CHECK(same);
+
+			// a value that isn't in the palette differs everywhere
+			storage.NotEqualMask(250, bits.data());
+			for (uint32_t i = 0; i < size && same; i++) {
+				same = ((bits[i / 64] >> (i % 64)) & 1) == 1;
+			}
+			SOGL_CHECK(same);
+		}
+	}
+}
+
+// access cost and footprint against the flat array VoxelStorage replaced
+SOGL_BENCHMARK(VoxelStorage_AgainstFlatArray) {
+	const std::vector<uint8_t> terrain = test::TerrainVoxels();
+	VoxelStorage storage;
+	storage.Pack(terrain.data(), ChunkSummary::VOXELS);
+	std::vector<uint8_t> flat = terrain;
+	std::vector<uint8_t> unpacked(ChunkSummary::VOXELS);
+
+	uint32_t sum = 0;
+	const double flatGet = test::BestOf(20, [&]() {
+		for (uint32_t i = 0; i < ChunkSummary::VOXELS; i++) {
+			sum += flat[i];
+		}
+		test::DoNotOptimize(&sum);
+	});
+	const double storageGet = test::BestOf(20, [&]() {
+		for (uint32_t i = 0; i < ChunkSummary::VOXELS; i++) {
+			sum += storage.Get(i);
+		}
+		test::DoNotOptimize(&sum);
+	});
+
+	const double flatSet = test::BestOf(20, [&]() {
+		for (uint32_t i = 0; i < ChunkSummary::VOXELS; i++) {
+			flat[i] = terrain[ChunkSummary::VOXELS - 1 - i];
+		}
+		test::DoNotOptimize(flat.data());
+	});
+	const double storageSet = test::BestOf(20, [&]() {
+		for (uint32_t i = 0; i < ChunkSummary::VOXELS; i++) {
+			storage.Set(i, terrain[ChunkSummary::VOXELS - 1 - i]);
+		}
+	});
+
+	const double pack = test::BestOf(50, [&]() { storage.Pack(terrain.data(), ChunkSummary::VOXELS); });
+	const double unpack = test::BestOf(50, [&]() {
+		storage.Unpack(unpacked.data());
+		test::DoNotOptimize(unpacked.data());
+	});
+
+	printf("  get, whole chunk:  flat %8.1f us, palette %8.1f us\n", flatGet, storageGet);
+	printf("  set, whole chunk:  flat %8.1f us, palette %8.1f us\n", flatSet, storageSet);
+	printf("  pack %.1f us, unpack %.1f us\n", pack, unpack);
+
+	VoxelStorage uniform(ChunkSummary::VOXELS, 0);
+	printf("  memory: flat %u B, terrain %llu B (%u bit), uniform %llu B\n", ChunkSummary::VOXELS,
+		static_cast<unsigned long long>(storage.MemoryUsage()), storage.BitsPerIndex(),
+		static_cast<unsigned long long>(uniform.MemoryUsage()));
+}
\ No newline at end of file
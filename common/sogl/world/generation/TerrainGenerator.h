@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <sogl/transform/vec3f.hpp>
+
+class FastNoise;
+
+namespace sogl {
+	enum class TerrainMode {
+		// 3D Perlin noise at every voxel, thresholded into materials
+		density,
+		// 2D fractal noise once per column for the surface height, filled with strata, with optional caves
+		heightmap
+	};
+
+	struct TerrainSettings {
+		TerrainMode mode = TerrainMode::heightmap;
+		// World seed. Each noise layer derives its own seed from it.
+		int32_t seed = 1337;
+
+		// World height of the surface where the height noise is 0.
+		int32_t baseHeight = 0;
+		// Largest distance of the surface from baseHeight, in voxels.
+		float heightScale = 48.0f;
+		float heightFrequency = 0.004f;
+		int32_t heightOctaves = 5;
+		// Number of dirt layers below the grass.
+		int32_t dirtDepth = 3;
+		// Depth below the surface at which stone turns into cobblestone.
+		int32_t cobblestoneDepth = 40;
+
+		// Caves are carved out of the top caveDepth voxels of each column, where the 3D cave noise is above caveThreshold.
+		bool caves = true;
+		int32_t caveDepth = 24;
+		float caveFrequency = 0.04f;
+		float caveThreshold = 0.35f;
+		// Spacing (in voxels) of the lattice the cave noise is sampled on, trilinearly interpolated in between.
+		// Must divide the chunk size, 1 samples every voxel.
+		int32_t caveSpacing = 4;
+
+		// Frequency of the 3D noise in density mode.
+		float densityFrequency = 0.01f;
+		// Lattice spacing of the density noise, like caveSpacing.
+		int32_t densitySpacing = 4;
+	};
+
+	/// <summary>
+	/// <para>Fills chunks with terrain. The output depends only on the settings and the chunk's position: the
+	/// generator holds no per-chunk state and seeds nothing from the clock, so any thread can generate any chunk,
+	/// neighbouring chunks line up, and a chunk that was dropped regenerates voxel for voxel. WorldHash identifies
+	/// the settings, so data derived from generated chunks can be checked against the generator it came from.</para>
+	/// <para>Heightmap mode samples 2D noise once per column instead of 3D noise once per voxel, and only evaluates
+	/// the cave noise in the band below the surface. Generate is const and may run on several threads at once.</para>
+	/// </summary>
+	class TerrainGenerator {
+		TerrainSettings m_settings;
+		uint64_t m_worldHash;
+		FastNoise* m_heightNoise;
+		FastNoise* m_caveNoise;
+		FastNoise* m_densityNoise;
+
+		void GenerateDensity(const vec3f& chunkOrigin, uint8_t* outVoxels) const;
+		void GenerateHeightmap(const vec3f& chunkOrigin, uint8_t* outVoxels) const;
+	public:
+		TerrainGenerator(const TerrainSettings& settings = TerrainSettings());
+		TerrainGenerator(const TerrainGenerator&) = delete;
+		~TerrainGenerator();
+
+		// Fills outVoxels in linear order (x fastest, then y, then z) for the chunk whose minimum corner is at chunkOrigin.
+		// Chunk reorders it if it uses a different layout.
+		void Generate(const vec3f& chunkOrigin, uint8_t* outVoxels) const;
+		// World height of the top solid voxel of the column at (x, z), before caves are carved. Heightmap mode only.
+		int32_t SurfaceHeight(const float x, const float z) const;
+
+		inline const TerrainSettings& Settings() const { return m_settings; }
+		// Hash of the seed and every setting that affects the output. Equal hashes generate equal chunks.
+		inline uint64_t WorldHash() const { return m_worldHash; }
+
+		// Fills out[(z * ySize + y) * xSize + x] with the noise at origin + (x, y, z), sampled every spacing voxels
+		// and trilinearly interpolated in between.
+		static void SampleNoise(const FastNoise& noise, const vec3f& origin, const int32_t xSize, const int32_t ySize, const int32_t zSize, const int32_t spacing, float* out);
+	};
+}
\ No newline at end of file
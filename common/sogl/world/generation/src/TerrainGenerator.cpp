@@ -0,0 +1,237 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include <sogl/noise/fastNoise.h>
+#include <sogl/structure/Hasher.h>
+#include <sogl/world/data/chunk.h>
+#include <sogl/world/generation/TerrainGenerator.h>
+
+namespace sogl {
+	static const int32_t SIZE = Chunk::CHUNK_SIZE;
+	static const int32_t SLICE = SIZE * SIZE;
+
+	enum NoiseLayer : uint64_t {
+		LAYER_HEIGHT = 1,
+		LAYER_CAVE = 2,
+		LAYER_DENSITY = 3
+	};
+
+	// so the layers of a world don't share (or correlate through neighbouring) FastNoise seeds
+	static int LayerSeed(const int32_t worldSeed, const NoiseLayer layer) {
+		return static_cast<int>(Hasher::Combine(static_cast<uint32_t>(worldSeed), layer));
+	}
+
+	template<typename T>
+	static uint64_t HashSetting(const uint64_t hash, const T value) {
+		// settings are ints, floats and bools, hashed by their bits
+		uint64_t bits = 0;
+		memcpy(&bits, &value, sizeof(T));
+		return Hasher::Combine(hash, bits);
+	}
+
+	static uint64_t HashSettings(const TerrainSettings& settings) {
+		uint64_t hash = HashSetting(0, static_cast<int32_t>(settings.mode));
+		hash = HashSetting(hash, settings.seed);
+		hash = HashSetting(hash, settings.baseHeight);
+		hash = HashSetting(hash, settings.heightScale);
+		hash = HashSetting(hash, settings.heightFrequency);
+		hash = HashSetting(hash, settings.heightOctaves);
+		hash = HashSetting(hash, settings.dirtDepth);
+		hash = HashSetting(hash, settings.cobblestoneDepth);
+		hash = HashSetting(hash, settings.caves);
+		hash = HashSetting(hash, settings.caveDepth);
+		hash = HashSetting(hash, settings.caveFrequency);
+		hash = HashSetting(hash, settings.caveThreshold);
+		hash = HashSetting(hash, settings.caveSpacing);
+		hash = HashSetting(hash, settings.densityFrequency);
+		hash = HashSetting(hash, settings.densitySpacing);
+		// 0 means unknown to region files
+		return hash != 0 ? hash : 1;
+	}
+
+	TerrainGenerator::TerrainGenerator(const TerrainSettings& settings)
+		: m_settings(settings), m_worldHash(0), m_heightNoise(new FastNoise(LayerSeed(settings.seed, LAYER_HEIGHT))),
+		m_caveNoise(new FastNoise(LayerSeed(settings.seed, LAYER_CAVE))), m_densityNoise(new FastNoise(LayerSeed(settings.seed, LAYER_DENSITY))) {
+		m_heightNoise->SetFrequency(settings.heightFrequency);
+		m_heightNoise->SetFractalOctaves(settings.heightOctaves);
+		m_caveNoise->SetFrequency(settings.caveFrequency);
+		m_densityNoise->SetFrequency(settings.densityFrequency);
+
+		// the lattice has to line up with the chunk borders, or neighbouring chunks would interpolate differently
+		if (settings.caveSpacing < 1 || SIZE % settings.caveSpacing != 0) {
+			printf("[Terrain Generator]: Cave spacing %d doesn't divide the chunk size, sampling every voxel instead!\n", settings.caveSpacing);
+			m_settings.caveSpacing = 1;
+		}
+		if (settings.densitySpacing < 1 || SIZE % settings.densitySpacing != 0) {
+			printf("[Terrain Generator]: Density spacing %d doesn't divide the chunk size, sampling every voxel instead!\n", settings.densitySpacing);
+			m_settings.densitySpacing = 1;
+		}
+
+		m_worldHash = HashSettings(m_settings);
+	}
+
+	TerrainGenerator::~TerrainGenerator() {
+		delete m_heightNoise;
+		delete m_caveNoise;
+		delete m_densityNoise;
+	}
+
+	void TerrainGenerator::Generate(const vec3f& chunkOrigin, uint8_t* outVoxels) const {
+		if (m_settings.mode == TerrainMode::heightmap)
+			GenerateHeightmap(chunkOrigin, outVoxels);
+		else
+			GenerateDensity(chunkOrigin, outVoxels);
+	}
+
+	int32_t TerrainGenerator::SurfaceHeight(const float x, const float z) const {
+		return m_settings.baseHeight + static_cast<int32_t>(floorf(m_heightNoise->GetSimplexFractal(x, z) * m_settings.heightScale));
+	}
+
+	void TerrainGenerator::SampleNoise(const FastNoise& noise, const vec3f& origin, const int32_t xSize, const int32_t ySize, const int32_t zSize, const int32_t spacing, float* out) {
+		if (spacing == 1) {
+			noise.FillPerlinGrid(out, origin.x, origin.y, origin.z, xSize, ySize, zSize);
+			return;
+		}
+
+		// lattice points needed to cover the last voxel on each axis
+		const int32_t latticeX = (xSize - 1 + spacing - 1) / spacing + 1;
+		const int32_t latticeY = (ySize - 1 + spacing - 1) / spacing + 1;
+		const int32_t latticeZ = (zSize - 1 + spacing - 1) / spacing + 1;
+
+		static thread_local std::vector<float> lattice;
+		static thread_local std::vector<float> plane;
+		static thread_local std::vector<float> row;
+		lattice.resize(latticeX * latticeY * latticeZ);
+		plane.resize(latticeX * latticeY);
+		row.resize(latticeX);
+		noise.FillPerlinGrid(lattice.data(), origin.x, origin.y, origin.z, latticeX, latticeY, latticeZ, static_cast<float>(spacing));
+
+		// separable: blend two lattice planes along z, two rows of that along y, then along x, so each voxel costs one lerp
+		const float inverseSpacing = 1.0f / spacing;
+		for (int32_t z = 0; z < zSize; z++) {
+			const float* plane0 = lattice.data() + (z / spacing) * latticeX * latticeY;
+			// on a lattice plane the next one may be past the end, and isn't needed
+			const float* plane1 = z % spacing == 0 ? plane0 : plane0 + latticeX * latticeY;
+			const float tz = (z % spacing) * inverseSpacing;
+			for (int32_t i = 0; i < latticeX * latticeY; i++)
+				plane[i] = plane0[i] + tz * (plane1[i] - plane0[i]);
+
+			for (int32_t y = 0; y < ySize; y++) {
+				const float* row0 = plane.data() + (y / spacing) * latticeX;
+				const float* row1 = y % spacing == 0 ? row0 : row0 + latticeX;
+				const float ty = (y % spacing) * inverseSpacing;
+				for (int32_t i = 0; i < latticeX; i++)
+					row[i] = row0[i] + ty * (row1[i] - row0[i]);
+
+				float* values = out + (static_cast<size_t>(z) * ySize + y) * xSize;
+				for (int32_t cell = 0; cell * spacing < xSize; cell++) {
+					const float v0 = row[cell];
+					const float delta = cell + 1 < latticeX ? row[cell + 1] - v0 : 0.0f;
+					const int32_t count = std::min(spacing, xSize - cell * spacing);
+					float* cellValues = values + cell * spacing;
+					for (int32_t i = 0; i < count; i++)
+						cellValues[i] = v0 + i * inverseSpacing * delta;
+				}
+			}
+		}
+	}
+
+	void TerrainGenerator::GenerateDensity(const vec3f& chunkOrigin, uint8_t* outVoxels) const {
+		static thread_local std::vector<float> noise;
+		noise.resize(SLICE * SIZE);
+		// the whole chunk at once, in the same linear order as the output
+		SampleNoise(*m_densityNoise, chunkOrigin, SIZE, SIZE, SIZE, m_settings.densitySpacing, noise.data());
+
+		for (int32_t i = 0; i < SLICE * SIZE; i++) {
+			if (noise[i] < 0.2)
+				outVoxels[i] = AIR;
+			else if (noise[i] < 0.4)
+				outVoxels[i] = STONE;
+			else if (noise[i] < 0.6)
+				outVoxels[i] = DIRT;
+			else if (noise[i] < 0.8)
+				outVoxels[i] = GRASS;
+			else
+				outVoxels[i] = COBBLESTONE;
+		}
+	}
+
+	void TerrainGenerator::GenerateHeightmap(const vec3f& chunkOrigin, uint8_t* outVoxels) const {
+		// surface height of every column, indexed z * SIZE + x
+		static thread_local int32_t heights[SLICE];
+
+		const int32_t baseY = static_cast<int32_t>(floorf(chunkOrigin.y));
+		int32_t minHeight = INT32_MAX;
+		int32_t maxHeight = INT32_MIN;
+		for (int32_t z = 0; z < SIZE; z++) {
+			for (int32_t x = 0; x < SIZE; x++) {
+				const int32_t height = SurfaceHeight(chunkOrigin.x + x, chunkOrigin.z + z);
+				heights[z * SIZE + x] = height;
+				minHeight = std::min(minHeight, height);
+				maxHeight = std::max(maxHeight, height);
+			}
+		}
+
+		// sky
+		if (maxHeight < baseY) {
+			memset(outVoxels, AIR, SLICE * SIZE);
+			return;
+		}
+
+		for (int32_t z = 0; z < SIZE; z++) {
+			const int32_t* rowHeights = heights + z * SIZE;
+			for (int32_t y = 0; y < SIZE; y++) {
+				const int32_t worldY = baseY + y;
+				uint8_t* types = outVoxels + (z * SIZE + y) * SIZE;
+
+				for (int32_t x = 0; x < SIZE; x++) {
+					const int32_t depth = rowHeights[x] - worldY;
+					if (depth < 0)
+						types[x] = AIR;
+					else if (depth == 0)
+						types[x] = GRASS;
+					else if (depth <= m_settings.dirtDepth)
+						types[x] = DIRT;
+					else if (depth < m_settings.cobblestoneDepth)
+						types[x] = STONE;
+					else
+						types[x] = COBBLESTONE;
+				}
+			}
+		}
+
+		if (!m_settings.caves)
+			return;
+
+		// only the band within caveDepth of the surface needs cave noise. Its bottom is aligned to the lattice so
+		// the interpolated noise lines up across chunks
+		int32_t bandLow = std::max(minHeight - m_settings.caveDepth + 1 - baseY, 0);
+		bandLow -= bandLow % m_settings.caveSpacing;
+		const int32_t bandHigh = std::min(maxHeight - baseY, SIZE - 1);
+		if (bandLow > bandHigh)
+			return;
+
+		const int32_t bandSize = bandHigh - bandLow + 1;
+		static thread_local std::vector<float> noise;
+		noise.resize(SLICE * bandSize);
+		SampleNoise(*m_caveNoise, vec3f(chunkOrigin.x, static_cast<float>(baseY + bandLow), chunkOrigin.z), SIZE, bandSize, SIZE, m_settings.caveSpacing, noise.data());
+
+		for (int32_t z = 0; z < SIZE; z++) {
+			const int32_t* rowHeights = heights + z * SIZE;
+			for (int32_t y = bandLow; y <= bandHigh; y++) {
+				const int32_t worldY = baseY + y;
+				const float* row = noise.data() + (z * bandSize + y - bandLow) * SIZE;
+				uint8_t* types = outVoxels + (z * SIZE + y) * SIZE;
+
+				for (int32_t x = 0; x < SIZE; x++) {
+					const int32_t depth = rowHeights[x] - worldY;
+					if (depth >= 0 && depth < m_settings.caveDepth && row[x] > m_settings.caveThreshold)
+						types[x] = AIR;
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+
+#include <sogl/transform/vec3i.hpp>
+
+namespace sogl {
+	class VoxelStorage;
+	template<typename T> class runLengthEncoding;
+
+	/// <summary>
+	/// <para>A single region file, holding up to 8x8x8 chunks.</para>
+	/// <para>The file starts with a header and an offset table with one entry per chunk slot, followed by chunk
+	/// records aligned to 4KB sectors. Each record holds either the chunk's palette and bit-packed index array, or
+	/// the run-length encoded voxels when that is smaller, so loading a chunk is a table lookup into the
+	/// memory-mapped file and a copy or decode into a VoxelStorage.</para>
+	/// <para>A saved record always goes to the first free run of sectors and the table entry is switched to it
+	/// afterwards, so a write that fails halfway leaves the previous copy readable. All methods are thread-safe.</para>
+	/// </summary>
+	class RegionFile {
+	public:
+		// version 2 added the record codec, version 1 records are all palette records. version 3 added the voxel
+		// layout, older files were all written linear
+		static const uint16_t VERSION = 3;
+		static const uint32_t REGION_SIZE = 8;
+		static const uint32_t CHUNKS_PER_REGION = REGION_SIZE * REGION_SIZE * REGION_SIZE;
+		static const uint32_t SECTOR_SIZE = 4096;
+	private:
+		struct Header {
+			char magic[4];
+			uint16_t version;
+			uint8_t regionSize;
+			// Chunk::Layout the records' voxels are in. the high byte of a 16 bit region size before version 3, so 0
+			// (linear) there
+			uint8_t layout;
+			// TerrainGenerator::WorldHash of the world the chunks were generated in, 0 if unknown
+			uint64_t worldHash;
+		};
+
+		struct TableEntry {
+			// first sector of the record, 0 if the slot is empty
+			uint32_t sector;
+			// length of the record in bytes
+			uint32_t length;
+		};
+
+		enum RecordCodec : uint8_t {
+			// palette, then the index array
+			CODEC_PALETTE = 0,
+			// runLengthEncoding of the flat voxel array
+			CODEC_RLE = 1
+		};
+
+		struct RecordHeader {
+			uint32_t voxelCount;
+			// palette records only
+			uint16_t paletteSize;
+			uint8_t bitsPerIndex;
+			uint8_t codec;
+		};
+
+		static const uint32_t HEADER_SECTORS = (sizeof(Header) + sizeof(TableEntry) * CHUNKS_PER_REGION + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+		TableEntry m_table[CHUNKS_PER_REGION];
+		std::vector<bool> m_usedSectors;
+
+		// platform file handle (HANDLE or file descriptor), -1 when closed
+		intptr_t m_file;
+		// file mapping object, only used on Windows
+		void* m_mapping;
+		const uint8_t* m_view;
+		uint64_t m_viewSize;
+		uint64_t m_fileSize;
+
+		std::mutex m_lock;
+
+		bool Map();
+		void Unmap();
+		// Close() without taking the lock.
+		void Release();
+		// Finds count free sectors, past the end of the file if need be, without marking them used.
+		uint32_t AllocateSectors(const uint32_t count);
+		bool WriteRecord(const uint32_t slot, std::vector<uint8_t>& record);
+	public:
+		RegionFile();
+		RegionFile(const RegionFile&) = delete;
+		~RegionFile();
+
+		// Opens the region file at path, creating an empty one if it doesn't exist and create is set. Fails on files
+		// written with the other Chunk::Layout, their voxels would load scrambled. Also fails on files saved with a
+		// different world hash, whose chunks won't line up with newly generated ones, unless allowOtherWorld is set.
+		bool Open(const char* path, const bool create, const uint64_t worldHash = 0, const bool allowOtherWorld = false);
+		void Close();
+
+		bool HasChunk(const uint32_t slot);
+		// Reads the chunk in the given slot into outVoxels. Returns false if the slot is empty or the record is corrupt.
+		bool LoadChunk(const uint32_t slot, VoxelStorage& outVoxels);
+		bool SaveChunk(const uint32_t slot, const VoxelStorage& voxels);
+		// Saves voxels that are already run-length encoded, without decoding them first.
+		bool SaveChunk(const uint32_t slot, const runLengthEncoding<uint8_t>& runs);
+
+		inline bool IsOpen() const { return m_file != -1; }
+
+		// Region containing the given chunk.
+		static vec3i ChunkToRegion(const vec3i& chunkCoord);
+		// Slot of the given chunk within its region.
+		static uint32_t ChunkSlot(const vec3i& chunkCoord);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <sogl/transform/vec3i.hpp>
+
+namespace sogl {
+	class RegionFile;
+	class VoxelStorage;
+	template<typename T> class runLengthEncoding;
+
+	/// <summary>
+	/// <para>Directory of region files, named r.x.y.z.region after their region coordinates.</para>
+	/// <para>Regions are opened on first use and kept open (and mapped) until Close(). Loads and saves may run on
+	/// any thread.</para>
+	/// </summary>
+	class RegionStore {
+		std::string m_directory;
+		uint64_t m_worldHash;
+		bool m_allowOtherWorld;
+		std::mutex m_lock;
+		// nullptr marks a region that was looked up for reading but has no file yet
+		std::unordered_map<uint64_t, RegionFile*> m_regions;
+		// regions whose file couldn't be created or opened for writing, e.g. one from another world. never retried
+		std::unordered_set<uint64_t> m_unusable;
+
+		RegionFile* GetRegion(const vec3i& regionCoord, const bool create);
+	public:
+		// The directory is created if it doesn't exist. Regions are stamped with worldHash, and regions from another
+		// world are neither loaded from nor saved to unless allowOtherWorld is set, see RegionFile::Open.
+		RegionStore(const char* directory, const uint64_t worldHash = 0, const bool allowOtherWorld = false);
+		RegionStore(const RegionStore&) = delete;
+		~RegionStore();
+
+		// Returns false if the chunk has never been saved.
+		bool LoadChunk(const vec3i& chunkCoord, VoxelStorage& outVoxels);
+		bool SaveChunk(const vec3i& chunkCoord, const VoxelStorage& voxels);
+		bool SaveChunk(const vec3i& chunkCoord, const runLengthEncoding<uint8_t>& runs);
+		// Closes every open region file.
+		void Close();
+
+		inline const std::string& Directory() const { return m_directory; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,440 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sogl/structure/runLengthEncoding.h>
+#include <sogl/world/io/RegionFile.h>
+#include <sogl/world/data/chunk.h>
+#include <sogl/world/data/VoxelStorage.h>
+
+namespace sogl {
+	static const char REGION_MAGIC[4] = { 'S', 'O', 'G', 'R' };
+	static const uint32_t CHUNK_VOXELS = Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE;
+
+	// VoxelStorage trusts its indices, so a record's are checked against its palette before they're handed over.
+	// indices may be unaligned.
+	static bool IndicesInRange(const uint8_t* indices, const uint32_t count, const uint8_t bitsPerIndex, const uint32_t paletteSize) {
+		// every value the width can hold is a valid index
+		if (bitsPerIndex == 0 || paletteSize >= (1u << bitsPerIndex))
+			return true;
+
+		const uint64_t mask = (1ull << bitsPerIndex) - 1;
+		const uint32_t perWord = 64 / bitsPerIndex;
+		const uint32_t words = (count + perWord - 1) / perWord;
+		for (uint32_t w = 0; w < words; w++) {
+			uint64_t word;
+			memcpy(&word, indices + w * sizeof(uint64_t), sizeof(word));
+
+			// the last word's unused fields are zero, which is always in range
+			for (uint32_t i = 0; i < perWord; i++, word >>= bitsPerIndex) {
+				if ((word & mask) >= paletteSize)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Thin wrappers over the platform file API, all offsets are absolute.
+	static bool WriteAt(const intptr_t file, const uint64_t offset, const void* data, const uint32_t size) {
+#ifdef _WIN32
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		DWORD written = 0;
+		return WriteFile(reinterpret_cast<HANDLE>(file), data, size, &written, &overlapped) && written == size;
+#else
+		return pwrite(static_cast<int>(file), data, size, static_cast<off_t>(offset)) == static_cast<ssize_t>(size);
+#endif
+	}
+
+	static uint64_t GetFileSize(const intptr_t file) {
+#ifdef _WIN32
+		LARGE_INTEGER size;
+		return GetFileSizeEx(reinterpret_cast<HANDLE>(file), &size) ? static_cast<uint64_t>(size.QuadPart) : 0;
+#else
+		struct stat info;
+		return fstat(static_cast<int>(file), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+#endif
+	}
+
+	RegionFile::RegionFile() : m_table(), m_usedSectors(), m_file(-1), m_mapping(nullptr), m_view(nullptr), m_viewSize(0), m_fileSize(0) {}
+
+	RegionFile::~RegionFile() {
+		Close();
+	}
+
+	bool RegionFile::Open(const char* path, const bool create, const uint64_t worldHash, const bool allowOtherWorld) {
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_file != -1)
+			return true;
+
+#ifdef _WIN32
+		HANDLE handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, create ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle == INVALID_HANDLE_VALUE)
+			return false;
+		m_file = reinterpret_cast<intptr_t>(handle);
+#else
+		int fd = open(path, create ? (O_RDWR | O_CREAT) : O_RDWR, 0644);
+		if (fd < 0)
+			return false;
+		m_file = fd;
+#endif
+
+		m_fileSize = GetFileSize(m_file);
+		if (m_fileSize == 0) {
+			// fresh file, write an empty header and table
+			std::vector<uint8_t> header(HEADER_SECTORS * SECTOR_SIZE, 0);
+			Header* h = reinterpret_cast<Header*>(header.data());
+			memcpy(h->magic, REGION_MAGIC, sizeof(REGION_MAGIC));
+			h->version = VERSION;
+			h->regionSize = REGION_SIZE;
+			h->layout = static_cast<uint8_t>(Chunk::LAYOUT);
+			h->worldHash = worldHash;
+
+			if (!WriteAt(m_file, 0, header.data(), static_cast<uint32_t>(header.size()))) {
+				printf("[Region File]: Could not initialize \"%s\"!\n", path);
+				Release();
+				return false;
+			}
+			m_fileSize = header.size();
+		}
+
+		if (m_fileSize < HEADER_SECTORS * SECTOR_SIZE || !Map()) {
+			printf("[Region File]: \"%s\" is truncated or could not be mapped!\n", path);
+			Release();
+			return false;
+		}
+
+		const Header* h = reinterpret_cast<const Header*>(m_view);
+		if (memcmp(h->magic, REGION_MAGIC, sizeof(REGION_MAGIC)) != 0 || h->version == 0 || h->version > VERSION || h->regionSize != REGION_SIZE) {
+			printf("[Region File]: \"%s\" is not a version %u region file!\n", path, VERSION);
+			Release();
+			return false;
+		}
+
+		// records are in storage order, so loading them into the other layout (and saving them back) scrambles them
+		if (h->layout != static_cast<uint8_t>(Chunk::LAYOUT)) {
+			printf("[Region File]: \"%s\" was saved with a different chunk layout!\n", path);
+			Release();
+			return false;
+		}
+
+		// generation is deterministic, so a different hash means regenerated neighbours won't match the saved chunks.
+		// mixing the two worlds in one file can't be undone
+		const bool otherWorld = h->worldHash != 0 && worldHash != 0 && h->worldHash != worldHash;
+		if (otherWorld && !allowOtherWorld) {
+			printf("[Region File]: \"%s\" was saved with a different world seed or terrain settings!\n", path);
+			Release();
+			return false;
+		}
+
+		// older records read the same, just bump the version so they can sit next to newer ones
+		if (h->version < VERSION) {
+			const uint16_t version = VERSION;
+			if (!WriteAt(m_file, offsetof(Header, version), &version, sizeof(version))) {
+				printf("[Region File]: Could not upgrade \"%s\"!\n", path);
+				Release();
+				return false;
+			}
+		}
+
+		if (h->worldHash == 0 && worldHash != 0) {
+			WriteAt(m_file, offsetof(Header, worldHash), &worldHash, sizeof(worldHash));
+		}
+		else if (otherWorld) {
+			printf("[Region File]: \"%s\" was saved with a different world seed or terrain settings, chunks may not line up!\n", path);
+		}
+
+		memcpy(m_table, m_view + sizeof(Header), sizeof(m_table));
+
+		// rebuild the sector map from the table, dropping entries that point outside the file
+		m_usedSectors.assign(static_cast<uint32_t>((m_fileSize + SECTOR_SIZE - 1) / SECTOR_SIZE), false);
+		for (uint32_t i = 0; i < HEADER_SECTORS; i++) {
+			m_usedSectors[i] = true;
+		}
+
+		for (TableEntry& entry : m_table) {
+			if (entry.sector == 0)
+				continue;
+
+			const uint32_t sectors = (entry.length + SECTOR_SIZE - 1) / SECTOR_SIZE;
+			if (entry.sector < HEADER_SECTORS || entry.sector + sectors > m_usedSectors.size()) {
+				entry = TableEntry();
+				continue;
+			}
+
+			for (uint32_t i = 0; i < sectors; i++) {
+				m_usedSectors[entry.sector + i] = true;
+			}
+		}
+
+		return true;
+	}
+
+	void RegionFile::Close() {
+		std::lock_guard<std::mutex> lock(m_lock);
+		Release();
+	}
+
+	void RegionFile::Release() {
+		Unmap();
+
+		if (m_file != -1) {
+#ifdef _WIN32
+			CloseHandle(reinterpret_cast<HANDLE>(m_file));
+#else
+			close(static_cast<int>(m_file));
+#endif
+			m_file = -1;
+		}
+
+		m_usedSectors.clear();
+		m_fileSize = 0;
+	}
+
+	bool RegionFile::Map() {
+		Unmap();
+
+#ifdef _WIN32
+		HANDLE mapping = CreateFileMappingA(reinterpret_cast<HANDLE>(m_file), nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+			return false;
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (view == nullptr) {
+			CloseHandle(mapping);
+			return false;
+		}
+		m_mapping = mapping;
+#else
+		void* view = mmap(nullptr, m_fileSize, PROT_READ, MAP_SHARED, static_cast<int>(m_file), 0);
+		if (view == MAP_FAILED)
+			return false;
+#endif
+
+		m_view = static_cast<const uint8_t*>(view);
+		m_viewSize = m_fileSize;
+		return true;
+	}
+
+	void RegionFile::Unmap() {
+		if (m_view == nullptr)
+			return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(m_view);
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+#else
+		munmap(const_cast<uint8_t*>(m_view), m_viewSize);
+#endif
+
+		m_view = nullptr;
+		m_viewSize = 0;
+	}
+
+	uint32_t RegionFile::AllocateSectors(const uint32_t count) {
+		// first fit, falling back to the end of the file
+		uint32_t run = 0;
+		for (uint32_t i = HEADER_SECTORS; i < m_usedSectors.size(); i++) {
+			run = m_usedSectors[i] ? 0 : run + 1;
+			if (run == count)
+				return i + 1 - count;
+		}
+
+		const uint32_t start = static_cast<uint32_t>(m_usedSectors.size()) - run;
+		m_usedSectors.resize(start + count, false);
+		return start;
+	}
+
+	bool RegionFile::HasChunk(const uint32_t slot) {
+		std::lock_guard<std::mutex> lock(m_lock);
+		return slot < CHUNKS_PER_REGION && m_table[slot].sector != 0;
+	}
+
+	bool RegionFile::LoadChunk(const uint32_t slot, VoxelStorage& outVoxels) {
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_file == -1 || slot >= CHUNKS_PER_REGION || m_table[slot].sector == 0)
+			return false;
+
+		const TableEntry& entry = m_table[slot];
+		const uint64_t offset = static_cast<uint64_t>(entry.sector) * SECTOR_SIZE;
+
+		// the file grew since it was mapped
+		if (offset + entry.length > m_viewSize) {
+			if (!Map() || offset + entry.length > m_viewSize)
+				return false;
+		}
+
+		const uint8_t* record = m_view + offset;
+		if (entry.length < sizeof(RecordHeader))
+			return false;
+
+		RecordHeader header;
+		memcpy(&header, record, sizeof(header));
+
+		// anything else is corrupt or from another build, and gets regenerated
+		if (header.voxelCount != CHUNK_VOXELS)
+			return false;
+
+		if (header.codec == CODEC_RLE) {
+			static thread_local std::vector<uint8_t> values;
+			values.resize(header.voxelCount);
+
+			runLengthEncoding<uint8_t> runs;
+			runs.assign(record + sizeof(RecordHeader), entry.length - sizeof(RecordHeader), header.voxelCount);
+			if (!runs.decode(values.data(), header.voxelCount))
+				return false;
+
+			outVoxels.Pack(values.data(), header.voxelCount);
+			return true;
+		}
+
+		if (header.codec != CODEC_PALETTE)
+			return false;
+
+		// only the widths VoxelStorage packs, anything else would also throw off the index reads below
+		const uint8_t bits = header.bitsPerIndex;
+		if (header.paletteSize == 0 || bits > 8 || (bits & (bits - 1)) != 0)
+			return false;
+
+		const uint64_t indexBytes = bits > 0 ? ((static_cast<uint64_t>(header.voxelCount) * bits + 63) / 64) * sizeof(uint64_t) : 0;
+		if (sizeof(RecordHeader) + header.paletteSize + indexBytes != entry.length)
+			return false;
+
+		const uint8_t* palette = record + sizeof(RecordHeader);
+		if (!IndicesInRange(palette + header.paletteSize, header.voxelCount, bits, header.paletteSize))
+			return false;
+
+		return outVoxels.Assign(header.voxelCount, palette, header.paletteSize, header.bitsPerIndex, palette + header.paletteSize);
+	}
+
+	bool RegionFile::SaveChunk(const uint32_t slot, const VoxelStorage& voxels) {
+		if (slot >= CHUNKS_PER_REGION)
+			return false;
+
+		// encode outside the lock
+		const std::vector<uint8_t>& palette = voxels.Palette();
+		const std::vector<uint64_t>& indices = voxels.Indices();
+		const uint64_t paletteBytes = palette.size() + indices.size() * sizeof(uint64_t);
+
+		RecordHeader header;
+		header.voxelCount = voxels.Size();
+		header.paletteSize = static_cast<uint16_t>(palette.size());
+		header.bitsPerIndex = voxels.BitsPerIndex();
+		header.codec = CODEC_PALETTE;
+
+		// terrain is mostly long runs along x, which usually beats even a 1 bit palette
+		runLengthEncoding<uint8_t> runs;
+		if (!voxels.IsUniform()) {
+			static thread_local std::vector<uint8_t> values;
+			values.resize(voxels.Size());
+			voxels.Unpack(values.data());
+			runs.encode(values.data(), voxels.Size());
+		}
+
+		std::vector<uint8_t> record;
+		if (!voxels.IsUniform() && runs.data().size() < paletteBytes) {
+			header.paletteSize = 0;
+			header.bitsPerIndex = 0;
+			header.codec = CODEC_RLE;
+
+			record.resize(sizeof(RecordHeader) + runs.data().size());
+			memcpy(record.data(), &header, sizeof(header));
+			memcpy(record.data() + sizeof(header), runs.data().data(), runs.data().size());
+		}
+		else {
+			record.resize(sizeof(RecordHeader) + paletteBytes);
+			memcpy(record.data(), &header, sizeof(header));
+			memcpy(record.data() + sizeof(header), palette.data(), palette.size());
+			if (!indices.empty()) {
+				memcpy(record.data() + sizeof(header) + palette.size(), indices.data(), indices.size() * sizeof(uint64_t));
+			}
+		}
+
+		return WriteRecord(slot, record);
+	}
+
+	bool RegionFile::SaveChunk(const uint32_t slot, const runLengthEncoding<uint8_t>& runs) {
+		if (slot >= CHUNKS_PER_REGION)
+			return false;
+
+		RecordHeader header;
+		header.voxelCount = runs.count();
+		header.paletteSize = 0;
+		header.bitsPerIndex = 0;
+		header.codec = CODEC_RLE;
+
+		std::vector<uint8_t> record(sizeof(RecordHeader) + runs.data().size());
+		memcpy(record.data(), &header, sizeof(header));
+		memcpy(record.data() + sizeof(header), runs.data().data(), runs.data().size());
+
+		return WriteRecord(slot, record);
+	}
+
+	bool RegionFile::WriteRecord(const uint32_t slot, std::vector<uint8_t>& record) {
+		const uint32_t length = static_cast<uint32_t>(record.size());
+		const uint32_t sectors = (length + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_file == -1)
+			return false;
+
+		const TableEntry oldEntry = m_table[slot];
+		const uint32_t oldSectors = (oldEntry.length + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+		// the new record never overwrites the old one, so a failed or interrupted write leaves the old copy and the
+		// table pointing at it. the sector map only changes once both writes went through.
+		TableEntry entry;
+		entry.sector = AllocateSectors(sectors);
+		entry.length = length;
+
+		// pad the record out to whole sectors so the file always ends on a sector boundary
+		record.resize(sectors * SECTOR_SIZE, 0);
+		const uint64_t offset = static_cast<uint64_t>(entry.sector) * SECTOR_SIZE;
+		if (!WriteAt(m_file, offset, record.data(), static_cast<uint32_t>(record.size())))
+			return false;
+
+		// the table entry goes last, so the record is only referenced once it has been written
+		if (!WriteAt(m_file, sizeof(Header) + slot * sizeof(TableEntry), &entry, sizeof(entry)))
+			return false;
+
+		if (oldEntry.sector != 0) {
+			for (uint32_t i = 0; i < oldSectors; i++) {
+				m_usedSectors[oldEntry.sector + i] = false;
+			}
+		}
+		for (uint32_t i = 0; i < sectors; i++) {
+			m_usedSectors[entry.sector + i] = true;
+		}
+
+		m_table[slot] = entry;
+		if (offset + record.size() > m_fileSize) {
+			m_fileSize = offset + record.size();
+		}
+
+		return true;
+	}
+
+	vec3i RegionFile::ChunkToRegion(const vec3i& chunkCoord) {
+		// arithmetic shift floors negative coordinates
+		return vec3i(chunkCoord.x >> 3, chunkCoord.y >> 3, chunkCoord.z >> 3);
+	}
+
+	uint32_t RegionFile::ChunkSlot(const vec3i& chunkCoord) {
+		const uint32_t mask = REGION_SIZE - 1;
+		return (chunkCoord.x & mask) + (chunkCoord.y & mask) * REGION_SIZE + (chunkCoord.z & mask) * REGION_SIZE * REGION_SIZE;
+	}
+}
\ No newline at end of file
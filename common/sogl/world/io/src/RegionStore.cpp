@@ -0,0 +1,94 @@
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <stdio.h>
+
+#include <sogl/structure/runLengthEncoding.h>
+#include <sogl/world/io/RegionStore.h>
+#include <sogl/world/io/RegionFile.h>
+
+namespace sogl {
+	static uint64_t PackRegionCoord(const vec3i& coord) {
+		return ((static_cast<uint64_t>(coord.x) & 0x1FFFFF) << 42) | ((static_cast<uint64_t>(coord.y) & 0x1FFFFF) << 21) | (static_cast<uint64_t>(coord.z) & 0x1FFFFF);
+	}
+
+	RegionStore::RegionStore(const char* directory, const uint64_t worldHash, const bool allowOtherWorld)
+		: m_directory(directory), m_worldHash(worldHash), m_allowOtherWorld(allowOtherWorld), m_lock(), m_regions(), m_unusable() {
+		// fails harmlessly if it already exists
+#ifdef _WIN32
+		_mkdir(directory);
+#else
+		mkdir(directory, 0755);
+#endif
+	}
+
+	RegionStore::~RegionStore() {
+		Close();
+	}
+
+	RegionFile* RegionStore::GetRegion(const vec3i& regionCoord, const bool create) {
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		const uint64_t key = PackRegionCoord(regionCoord);
+		auto it = m_regions.find(key);
+		if (it != m_regions.end() && (it->second != nullptr || !create))
+			return it->second;
+		if (m_unusable.count(key) != 0)
+			return nullptr;
+
+		char path[512];
+		snprintf(path, sizeof(path), "%s/r.%d.%d.%d.region", m_directory.c_str(), regionCoord.x, regionCoord.y, regionCoord.z);
+
+		RegionFile* region = new RegionFile();
+		if (!region->Open(path, create, m_worldHash, m_allowOtherWorld)) {
+			delete region;
+			region = nullptr;
+
+			// a missing file is only worth another look once there's something to save
+			if (create) {
+				m_unusable.insert(key);
+			}
+		}
+
+		m_regions[key] = region;
+		return region;
+	}
+
+	bool RegionStore::LoadChunk(const vec3i& chunkCoord, VoxelStorage& outVoxels) {
+		RegionFile* region = GetRegion(RegionFile::ChunkToRegion(chunkCoord), false);
+		return region != nullptr && region->LoadChunk(RegionFile::ChunkSlot(chunkCoord), outVoxels);
+	}
+
+	bool RegionStore::SaveChunk(const vec3i& chunkCoord, const VoxelStorage& voxels) {
+		RegionFile* region = GetRegion(RegionFile::ChunkToRegion(chunkCoord), true);
+		if (region == nullptr) {
+			printf("[Region Store]: Could not open the region for chunk (%d, %d, %d) in \"%s\"!\n", chunkCoord.x, chunkCoord.y, chunkCoord.z, m_directory.c_str());
+			return false;
+		}
+
+		return region->SaveChunk(RegionFile::ChunkSlot(chunkCoord), voxels);
+	}
+
+	bool RegionStore::SaveChunk(const vec3i& chunkCoord, const runLengthEncoding<uint8_t>& runs) {
+		RegionFile* region = GetRegion(RegionFile::ChunkToRegion(chunkCoord), true);
+		if (region == nullptr) {
+			printf("[Region Store]: Could not open the region for chunk (%d, %d, %d) in \"%s\"!\n", chunkCoord.x, chunkCoord.y, chunkCoord.z, m_directory.c_str());
+			return false;
+		}
+
+		return region->SaveChunk(RegionFile::ChunkSlot(chunkCoord), runs);
+	}
+
+	void RegionStore::Close() {
+		std::lock_guard<std::mutex> lock(m_lock);
+		for (auto& pair : m_regions) {
+			delete pair.second;
+		}
+
+		m_regions.clear();
+		m_unusable.clear();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <sogl/test/Test.h>
+#include <sogl/world/data/chunk.h>
+#include <sogl/world/data/VoxelStorage.h>
+#include <sogl/world/io/RegionFile.h>
+
+using namespace sogl;
+
+static const char* TEST_REGION_PATH = "sogl_test_region.bin";
+// magic, version, region size, layout and world hash come before the offset table
+static const uint32_t LAYOUT_OFFSET = 7;
+static const uint32_t TABLE_OFFSET = 16;
+
+static VoxelStorage Speckled(const uint32_t types) {
+	std::vector<uint8_t> values(ChunkSummary::VOXELS);
+	for (uint32_t i = 0; i < ChunkSummary::VOXELS; i++) {
+		values[i] = static_cast<uint8_t>(((i * 2654435761u) >> 13) % types);
+	}
+
+	VoxelStorage voxels;
+	voxels.Pack(values.data(), ChunkSummary::VOXELS);
+	return voxels;
+}
+
+static bool SameVoxels(const VoxelStorage& a, const VoxelStorage& b) {
+	std::vector<uint8_t> valuesA(a.Size());
+	std::vector<uint8_t> valuesB(b.Size());
+	a.Unpack(valuesA.data());
+	b.Unpack(valuesB.data());
+	return valuesA == valuesB;
+}
+
+static void ReadEntry(const uint32_t slot, uint32_t& outSector, uint32_t& outLength) {
+	FILE* file = fopen(TEST_REGION_PATH, "rb");
+	uint32_t entry[2] = {};
+	fseek(file, TABLE_OFFSET + slot * sizeof(entry), SEEK_SET);
+	fread(entry, sizeof(entry), 1, file);
+	fclose(file);
+
+	outSector = entry[0];
+	outLength = entry[1];
+}
+
+// Overwrites bytes of the record in slot, at offset from its start.
+static void PatchRecord(const uint32_t slot, const uint32_t offset, const void* data, const uint32_t size) {
+	uint32_t sector;
+	uint32_t length;
+	ReadEntry(slot, sector, length);
+
+	FILE* file = fopen(TEST_REGION_PATH, "r+b");
+	fseek(file, sector * RegionFile::SECTOR_SIZE + offset, SEEK_SET);
+	fwrite(data, size, 1, file);
+	fclose(file);
+}
+
+static void PatchFile(const uint32_t offset, const void* data, const uint32_t size) {
+	FILE* file = fopen(TEST_REGION_PATH, "r+b");
+	fseek(file, offset, SEEK_SET);
+	fwrite(data, size, 1, file);
+	fclose(file);
+}
+
+static long FileSize() {
+	FILE* file = fopen(TEST_REGION_PATH, "rb");
+	fseek(file, 0, SEEK_END);
+	const long size = ftell(file);
+	fclose(file);
+	return size;
+}
+
+SOGL_TEST(RegionFile_RoundTrip) {
+	remove(TEST_REGION_PATH);
+	const VoxelStorage uniform(ChunkSummary::VOXELS, 2);
+	const VoxelStorage speckled = Speckled(3);
+
+	{
+		RegionFile region;
+		SOGL_CHECK(region.Open(TEST_REGION_PATH, true));
+		SOGL_CHECK(region.SaveChunk(0, uniform));
+		SOGL_CHECK(region.SaveChunk(7, speckled));
+	}
+
+	RegionFile region;
+	SOGL_CHECK(region.Open(TEST_REGION_PATH, false));
+	SOGL_CHECK(!region.HasChunk(1));
+
+	VoxelStorage loaded;
+	SOGL_CHECK(region.LoadChunk(0, loaded) && SameVoxels(loaded, uniform));
+	SOGL_CHECK(region.LoadChunk(7, loaded) && SameVoxels(loaded, speckled));
+
+	region.Close();
+	remove(TEST_REGION_PATH);
+}
+
+SOGL_TEST(RegionFile_RejectsCorruptRecords) {
+	remove(TEST_REGION_PATH);
+	{
+		RegionFile region;
+		SOGL_CHECK(region.Open(TEST_REGION_PATH, true));
+		// a uniform record has no indices, so its length still adds up with any voxel count
+		SOGL_CHECK(region.SaveChunk(0, VoxelStorage(ChunkSummary::VOXELS, 1)));
+		// 3 palette entries at 2 bits leaves index 3 unused, so there is an out of range value to write. these
+		// values hardly repeat, so run-length encoding loses and this is a palette record.
+		SOGL_CHECK(region.SaveChunk(1, Speckled(3)));
+	}
+
+	// record header: voxel count, palette size, bits per index, codec. then the palette and the indices
+	const uint32_t badCount = ChunkSummary::VOXELS / 2;
+	PatchRecord(0, 0, &badCount, sizeof(badCount));
+	const uint8_t badIndices = 0xFF;
+	PatchRecord(1, 8 + 3, &badIndices, sizeof(badIndices));
+
+	RegionFile region;
+	SOGL_CHECK(region.Open(TEST_REGION_PATH, false));
+	VoxelStorage loaded(ChunkSummary::VOXELS, 4);
+	SOGL_CHECK(!region.LoadChunk(0, loaded));
+	SOGL_CHECK(!region.LoadChunk(1, loaded));
+	// and the storage is left as it was
+	SOGL_CHECK(loaded.IsUniform() && loaded.Get(0) == 4);
+
+	region.Close();
+	remove(TEST_REGION_PATH);
+}
+
+SOGL_TEST(RegionFile_SaveKeepsOldCopyUntilWritten) {
+	remove(TEST_REGION_PATH);
+	RegionFile region;
+	SOGL_CHECK(region.Open(TEST_REGION_PATH, true));
+
+	SOGL_CHECK(region.SaveChunk(0, Speckled(3)));
+	uint32_t firstSector;
+	uint32_t length;
+	ReadEntry(0, firstSector, length);
+	const long firstSize = FileSize();
+
+	// the new copy goes to free sectors, never on top of the one the table points at
+	SOGL_CHECK(region.SaveChunk(0, Speckled(4)));
+	uint32_t secondSector;
+	ReadEntry(0, secondSector, length);
+	SOGL_CHECK(secondSector != firstSector);
+	SOGL_CHECK(FileSize() > firstSize);
+
+	// once switched over, the old sectors are free again and the next save reuses them
+	SOGL_CHECK(region.SaveChunk(0, Speckled(3)));
+	uint32_t thirdSector;
+	ReadEntry(0, thirdSector, length);
+	SOGL_CHECK(thirdSector == firstSector);
+
+	VoxelStorage loaded;
+	SOGL_CHECK(region.LoadChunk(0, loaded) && SameVoxels(loaded, Speckled(3)));
+
+	region.Close();
+	remove(TEST_REGION_PATH);
+}
+
+SOGL_TEST(RegionFile_RejectsOtherLayout) {
+	remove(TEST_REGION_PATH);
+	{
+		RegionFile region;
+		SOGL_CHECK(region.Open(TEST_REGION_PATH, true));
+		SOGL_CHECK(region.SaveChunk(0, Speckled(3)));
+	}
+
+	// stamped as written by a build with the other layout
+	const Chunk::Layout other = Chunk::LAYOUT == Chunk::Layout::linear ? Chunk::Layout::morton : Chunk::Layout::linear;
+	const uint8_t otherLayout = static_cast<uint8_t>(other);
+	PatchFile(LAYOUT_OFFSET, &otherLayout, sizeof(otherLayout));
+
+	RegionFile region;
+	SOGL_CHECK(!region.Open(TEST_REGION_PATH, false));
+	SOGL_CHECK(!region.Open(TEST_REGION_PATH, true));
+	SOGL_CHECK(!region.IsOpen());
+
+	// and left alone, so the right build still reads it
+	const uint8_t layout = static_cast<uint8_t>(Chunk::LAYOUT);
+	PatchFile(LAYOUT_OFFSET, &layout, sizeof(layout));
+	VoxelStorage loaded;
+	SOGL_CHECK(region.Open(TEST_REGION_PATH, false));
+	SOGL_CHECK(region.LoadChunk(0, loaded) && SameVoxels(loaded, Speckled(3)));
+
+	region.Close();
+	remove(TEST_REGION_PATH);
+}
+
+SOGL_TEST(RegionFile_RejectsOtherWorld) {
+	remove(TEST_REGION_PATH);
+	{
+		RegionFile region;
+		SOGL_CHECK(region.Open(TEST_REGION_PATH, true, 1));
+		SOGL_CHECK(region.SaveChunk(0, Speckled(3)));
+	}
+	const long size = FileSize();
+
+	// neither read nor written, even when asked to create it
+	RegionFile region;
+	SOGL_CHECK(!region.Open(TEST_REGION_PATH, false, 2));
+	SOGL_CHECK(!region.Open(TEST_REGION_PATH, true, 2));
+	SOGL_CHECK(!region.IsOpen() && FileSize() == size);
+
+	// unless that's asked for, and a world without a hash takes any file
+	SOGL_CHECK(region.Open(TEST_REGION_PATH, false, 2, true));
+	region.Close();
+	VoxelStorage loaded;
+	SOGL_CHECK(region.Open(TEST_REGION_PATH, false, 0));
+	SOGL_CHECK(region.LoadChunk(0, loaded) && SameVoxels(loaded, Speckled(3)));
+
+	region.Close();
+	remove(TEST_REGION_PATH);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include <stdio.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <sogl/test/Test.h>
+#include <sogl/world/data/chunk.h>
+#include <sogl/world/data/VoxelStorage.h>
+#include <sogl/world/io/RegionStore.h>
+
+using namespace sogl;
+
+static const char* TEST_STORE_DIRECTORY = "sogl_test_store";
+// chunk (0, 0, 0) lives in region (0, 0, 0)
+static const char* TEST_STORE_REGION = "sogl_test_store/r.0.0.0.region";
+
+static void RemoveStore() {
+	remove(TEST_STORE_REGION);
+#ifdef _WIN32
+	_rmdir(TEST_STORE_DIRECTORY);
+#else
+	rmdir(TEST_STORE_DIRECTORY);
+#endif
+}
+
+SOGL_TEST(RegionStore_LeavesOtherWorldAlone) {
+	RemoveStore();
+	const VoxelStorage saved(ChunkSummary::VOXELS, 3);
+	{
+		RegionStore store(TEST_STORE_DIRECTORY, 1);
+		SOGL_CHECK(store.SaveChunk(vec3i(0, 0, 0), saved));
+	}
+
+	// another world neither loads the old chunks nor saves its own next to them
+	VoxelStorage loaded(ChunkSummary::VOXELS, 1);
+	{
+		RegionStore store(TEST_STORE_DIRECTORY, 2);
+		SOGL_CHECK(!store.LoadChunk(vec3i(0, 0, 0), loaded));
+		SOGL_CHECK(!store.SaveChunk(vec3i(1, 0, 0), VoxelStorage(ChunkSummary::VOXELS, 2)));
+		SOGL_CHECK(!store.SaveChunk(vec3i(0, 0, 0), VoxelStorage(ChunkSummary::VOXELS, 2)));
+	}
+
+	{
+		RegionStore store(TEST_STORE_DIRECTORY, 1);
+		SOGL_CHECK(store.LoadChunk(vec3i(0, 0, 0), loaded) && loaded.IsUniform() && loaded.Get(0) == 3);
+		SOGL_CHECK(!store.LoadChunk(vec3i(1, 0, 0), loaded));
+	}
+
+	// unless it's allowed to
+	{
+		RegionStore store(TEST_STORE_DIRECTORY, 2, true);
+		SOGL_CHECK(store.LoadChunk(vec3i(0, 0, 0), loaded) && loaded.Get(0) == 3);
+	}
+
+	RemoveStore();
+}
\ No newline at end of file
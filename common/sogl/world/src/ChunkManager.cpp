@@ -0,0 +1,819 @@
+#include <GLEW/glew.h>
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sogl/world/ChunkManager.h>
+#include <sogl/world/data/chunk.h>
+#include <sogl/world/data/chunkMesh.h>
+#include <sogl/world/io/RegionStore.h>
+
+namespace sogl {
+	// indexed by FaceDirection
+	static const vec3i NEIGHBOUR_OFFSETS[6] = {
+		vec3i(0, -1, 0),
+		vec3i(0, 1, 0),
+		vec3i(-1, 0, 0),
+		vec3i(1, 0, 0),
+		vec3i(0, 0, -1),
+		vec3i(0, 0, 1)
+	};
+
+	ChunkManager::ChunkBuildResult::~ChunkBuildResult() {
+		delete mesh;
+		delete chunk;
+	}
+
+	ChunkManager::ChunkManager(const ChunkManagerSettings& settings)
+		: m_settings(settings), m_jobs(settings.workerThreads), m_generator(settings.terrain),
+		m_regions(settings.saveDirectory != nullptr ? new RegionStore(settings.saveDirectory, m_generator.WorldHash(), settings.openOtherWorldSaves) : nullptr), m_loadedChunks(), m_pendingJobs(), m_warmMemoryUsage(0), m_loadQueue(),
+		m_centerChunk(), m_hasCenter(false), m_memoryUsage(0), m_demotingMemoryUsage(0), m_drawEntries(), m_drawBounds(), m_drawVisible(),
+		m_occlusionQueue(), m_occlusionVisited(), m_renderStats(), m_timerQueries(), m_timerFrame(0) {}
+
+	ChunkManager::~ChunkManager() {
+		Clear();
+		delete m_regions;
+	}
+
+	void ChunkManager::Update(const vec3f& cameraPosition) {
+		vec3i center = WorldToChunk(cameraPosition);
+
+		// only rebuild the queue when the camera crosses a chunk boundary
+		if (!m_hasCenter || center != m_centerChunk) {
+			m_centerChunk = center;
+			m_hasCenter = true;
+
+			EvictOutOfRange();
+			RebuildLoadQueue();
+			RefreshLods();
+
+			// queued jobs keep the priority they were scheduled with, so re-sort them around the new center
+			m_jobs.Reprioritize([this](uint64_t tag) {
+				// demotions free memory, so they stay at the front of the queue wherever the camera is
+				if (tag & DEMOTION_TAG)
+					return 0.0f;
+
+				return static_cast<float>(DistanceSquared(UnpackCoord(tag)));
+			});
+		}
+
+		while (m_pendingJobs.size() < m_settings.maxPendingJobs && !m_loadQueue.empty()) {
+			vec3i coord = m_loadQueue.back();
+			m_loadQueue.pop_back();
+
+			uint64_t key = PackCoord(coord);
+			// chunks still being compressed are queued again once they are warm
+			if (m_loadedChunks.find(key) != m_loadedChunks.end() || m_pendingJobs.find(key) != m_pendingJobs.end()
+				|| m_pendingDemotions.find(key) != m_pendingDemotions.end())
+				continue;
+
+			if (!ScheduleChunk(coord))
+				break;
+		}
+
+		CollectDemotions();
+		// uploads are capped per update so a burst of finished jobs can't stall a frame
+		m_jobs.ProcessCompleted(m_settings.uploadsPerUpdate);
+
+		EnforceMemoryBudget();
+	}
+
+	void ChunkManager::Draw(const Frustum* frustum) {
+		if (m_timerQueries[0] == 0) {
+			glGenQueries(2, m_timerQueries);
+		}
+
+		// the query issued two frames ago has almost certainly finished, only read it if it has
+		const uint32_t current = m_timerQueries[m_timerFrame & 1];
+		if (m_timerFrame >= 2) {
+			GLint available = 0;
+			glGetQueryObjectiv(current, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available) {
+				GLuint64 elapsed = 0;
+				glGetQueryObjectui64v(current, GL_QUERY_RESULT, &elapsed);
+				m_renderStats.gpuTimeMs = elapsed / 1000000.0;
+			}
+		}
+
+		m_renderStats.drawnChunks = 0;
+		m_renderStats.culledChunks = 0;
+		m_renderStats.triangles = 0;
+
+		m_drawEntries.clear();
+		m_drawBounds.Clear();
+		const vec3f chunkExtent(Chunk::CHUNK_SIZE_X, Chunk::CHUNK_SIZE_Y, Chunk::CHUNK_SIZE_Z);
+		for (auto& pair : m_loadedChunks) {
+			const ChunkEntry& entry = pair.second;
+			if (!entry.mesh->IsUploaded() || entry.mesh->QuadCount() == 0)
+				continue;
+			// walled in, unless the camera is inside it
+			if (entry.enclosed && entry.coord != m_centerChunk)
+				continue;
+
+			m_drawEntries.push_back(&entry);
+			m_drawBounds.Add(entry.chunk->getChunkCoords(), entry.chunk->getChunkCoords() + chunkExtent);
+		}
+
+		m_drawVisible.assign(m_drawEntries.size(), 1);
+		if (m_settings.occlusionCulling && m_hasCenter) {
+			// the flood only enters chunks inside the frustum, so it covers both tests
+			FloodVisibleChunks(frustum);
+			for (size_t i = 0; i < m_drawEntries.size(); i++) {
+				const int32_t cell = OcclusionCell(m_drawEntries[i]->coord);
+				m_drawVisible[i] = cell < 0 || m_occlusionVisited[cell];
+			}
+		}
+		else if (frustum != nullptr) {
+			// every box is tested, so chunks behind the camera only cost their share of a SIMD plane test
+			frustum->TestAABBs(m_drawBounds, m_drawVisible.data());
+		}
+
+		glBeginQuery(GL_TIME_ELAPSED, current);
+		ChunkMesh::BeginDraw();
+		for (size_t i = 0; i < m_drawEntries.size(); i++) {
+			const ChunkEntry& entry = *m_drawEntries[i];
+			if (!m_drawVisible[i]) {
+				m_renderStats.culledChunks++;
+				continue;
+			}
+
+			entry.mesh->Draw(entry.chunk->getChunkCoords());
+			m_renderStats.drawnChunks++;
+			m_renderStats.triangles += entry.mesh->TriangleCount();
+		}
+		ChunkMesh::EndDraw();
+		glEndQuery(GL_TIME_ELAPSED);
+
+		m_timerFrame++;
+	}
+
+	void ChunkManager::Clear() {
+		m_jobs.CancelAll();
+		m_pendingJobs.clear();
+		m_pendingRemeshes.clear();
+
+		// the workers are idle now, so chunks that were being compressed can be saved straight from their voxels
+		for (auto& pair : m_pendingDemotions) {
+			PendingDemotion& demotion = pair.second;
+			if (m_regions != nullptr && demotion.warm->unsaved) {
+				m_regions->SaveChunk(UnpackCoord(pair.first), demotion.chunk->getStorage());
+			}
+			delete demotion.chunk;
+		}
+		m_pendingDemotions.clear();
+
+		while (!m_warmLru.empty()) {
+			RemoveWarmChunk(m_warmLru.back(), true);
+		}
+
+		for (auto& pair : m_loadedChunks) {
+			SaveChunk(pair.second);
+			delete pair.second.mesh;
+			delete pair.second.chunk;
+		}
+
+		m_loadedChunks.clear();
+		m_loadQueue.clear();
+		m_memoryUsage = 0;
+		m_demotingMemoryUsage = 0;
+		m_hasCenter = false;
+
+		if (m_timerQueries[0] != 0) {
+			glDeleteQueries(2, m_timerQueries);
+			m_timerQueries[0] = m_timerQueries[1] = 0;
+			m_timerFrame = 0;
+		}
+	}
+
+	bool ChunkManager::FindChunk(const vec3i& coord, Chunk*& outChunk) const {
+		auto it = m_loadedChunks.find(PackCoord(coord));
+		if (it == m_loadedChunks.end())
+			return false;
+
+		outChunk = it->second.chunk;
+		return true;
+	}
+
+	bool ChunkManager::SetVoxel(const vec3i& worldVoxel, const voxelType type) {
+		// floor division, so negative coordinates land in the chunk below rather than rounding towards zero
+		auto floorDiv = [](int32_t v, int32_t size) { return v >= 0 ? v / size : (v - size + 1) / size; };
+		const vec3i coord(
+			floorDiv(worldVoxel.x, Chunk::CHUNK_SIZE_X),
+			floorDiv(worldVoxel.y, Chunk::CHUNK_SIZE_Y),
+			floorDiv(worldVoxel.z, Chunk::CHUNK_SIZE_Z));
+		const uint16_t x = static_cast<uint16_t>(worldVoxel.x - coord.x * Chunk::CHUNK_SIZE_X);
+		const uint16_t y = static_cast<uint16_t>(worldVoxel.y - coord.y * Chunk::CHUNK_SIZE_Y);
+		const uint16_t z = static_cast<uint16_t>(worldVoxel.z - coord.z * Chunk::CHUNK_SIZE_Z);
+
+		const uint64_t key = PackCoord(coord);
+		auto it = m_loadedChunks.find(key);
+		if (it == m_loadedChunks.end())
+			return false;
+
+		ChunkEntry& entry = it->second;
+		entry.unsaved = true;
+		const bool wasSolid = entry.chunk->getVoxel(x, y, z).type != AIR;
+		entry.chunk->setVoxel(x, y, z, type);
+		if (entry.mesh->Lod() == 0) {
+			entry.mesh->ApplyEdit(entry.chunk->getStorage(), x, y, z);
+		}
+
+		// level-of-detail meshes can't be patched, and a remesh in flight was built from a snapshot without this edit
+		if (entry.mesh->Lod() != 0 || m_pendingRemeshes.find(key) != m_pendingRemeshes.end()) {
+			ScheduleRemesh(coord);
+		}
+
+		m_memoryUsage -= entry.memoryUsage;
+		entry.memoryUsage = entry.chunk->getMemoryUsage() + entry.mesh->MemoryUsage();
+		m_memoryUsage += entry.memoryUsage;
+
+		// neighbours only see the solid bit of our boundary slices
+		const bool isSolid = type != AIR;
+		if (wasSolid == isSolid)
+			return true;
+
+		const uint16_t last = Chunk::CHUNK_SIZE - 1;
+		const bool onBoundary[6] = { y == 0, y == last, x == 0, x == last, z == 0, z == last };
+		for (uint32_t dir = 0; dir < 6; dir++) {
+			if (!onBoundary[dir])
+				continue;
+
+			const vec3i neighbourCoord = coord + NEIGHBOUR_OFFSETS[dir];
+			const uint64_t neighbourKey = PackCoord(neighbourCoord);
+			auto neighbour = m_loadedChunks.find(neighbourKey);
+			if (neighbour == m_loadedChunks.end())
+				continue;
+
+			// seen from the neighbour we are on the opposite side
+			const FaceDirection side = static_cast<FaceDirection>(dir ^ 1);
+			ChunkEntry& neighbourEntry = neighbour->second;
+			if (neighbourEntry.mesh->Lod() == 0) {
+				neighbourEntry.mesh->ApplyBorderEdit(neighbourEntry.chunk->getStorage(), side, x, y, z, isSolid);
+			}
+			neighbourEntry.enclosed = IsEnclosed(neighbourCoord);
+
+			if (neighbourEntry.mesh->Lod() != 0 || m_pendingRemeshes.find(neighbourKey) != m_pendingRemeshes.end()) {
+				ScheduleRemesh(neighbourCoord);
+			}
+
+			m_memoryUsage -= neighbourEntry.memoryUsage;
+			neighbourEntry.memoryUsage = neighbourEntry.chunk->getMemoryUsage() + neighbourEntry.mesh->MemoryUsage();
+			m_memoryUsage += neighbourEntry.memoryUsage;
+		}
+
+		return true;
+	}
+
+	void ChunkManager::SetSettings(const ChunkManagerSettings& settings) {
+		const char* oldDirectory = m_settings.saveDirectory;
+		const char* newDirectory = settings.saveDirectory;
+		const bool directoryChanged = (oldDirectory == nullptr) != (newDirectory == nullptr)
+			|| (oldDirectory != nullptr && strcmp(oldDirectory, newDirectory) != 0);
+
+		// a different save directory is a different world, so everything resident goes back to the old one first
+		if (directoryChanged) {
+			Clear();
+			delete m_regions;
+			m_regions = newDirectory != nullptr ? new RegionStore(newDirectory, m_generator.WorldHash(), settings.openOtherWorldSaves) : nullptr;
+		}
+
+		m_settings = settings;
+		// the generator can't change under chunks that were already generated or saved with it
+		m_settings.terrain = m_generator.Settings();
+		// force the next update to re-evaluate which chunks should be resident
+		m_hasCenter = false;
+	}
+
+	vec3i ChunkManager::WorldToChunk(const vec3f& position) {
+		return vec3i(
+			static_cast<int32_t>(floorf(position.x / Chunk::CHUNK_SIZE_X)),
+			static_cast<int32_t>(floorf(position.y / Chunk::CHUNK_SIZE_Y)),
+			static_cast<int32_t>(floorf(position.z / Chunk::CHUNK_SIZE_Z)));
+	}
+
+	vec3f ChunkManager::ChunkToWorld(const vec3i& coord) {
+		return vec3f(
+			static_cast<float>(coord.x * Chunk::CHUNK_SIZE_X),
+			static_cast<float>(coord.y * Chunk::CHUNK_SIZE_Y),
+			static_cast<float>(coord.z * Chunk::CHUNK_SIZE_Z));
+	}
+
+	uint64_t ChunkManager::PackCoord(const vec3i& coord) {
+		// 21 bits per axis is plenty for any reachable chunk coordinate
+		const uint64_t mask = (1ull << 21) - 1;
+		return ((static_cast<uint64_t>(coord.x) & mask) << 42) |
+			((static_cast<uint64_t>(coord.y) & mask) << 21) |
+			(static_cast<uint64_t>(coord.z) & mask);
+	}
+
+	vec3i ChunkManager::UnpackCoord(const uint64_t key) {
+		// shift each 21 bit field to the top of the word, then arithmetic shift back down to sign extend it
+		return vec3i(
+			static_cast<int32_t>(static_cast<int64_t>(key << 1) >> 43),
+			static_cast<int32_t>(static_cast<int64_t>(key << 22) >> 43),
+			static_cast<int32_t>(static_cast<int64_t>(key << 43) >> 43));
+	}
+
+	bool ChunkManager::InRange(const vec3i& coord, const int32_t padding) const {
+		const int32_t radius = m_settings.viewRadius + padding;
+		const int32_t dx = coord.x - m_centerChunk.x;
+		const int32_t dy = coord.y - m_centerChunk.y;
+		const int32_t dz = coord.z - m_centerChunk.z;
+
+		return (dx * dx + dz * dz) <= radius * radius && abs(dy) <= m_settings.verticalRadius + padding;
+	}
+
+	int64_t ChunkManager::DistanceSquared(const vec3i& coord) const {
+		const int64_t dx = coord.x - m_centerChunk.x;
+		const int64_t dy = coord.y - m_centerChunk.y;
+		const int64_t dz = coord.z - m_centerChunk.z;
+
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	uint32_t ChunkManager::LodFor(const vec3i& coord) const {
+		if (m_settings.lodDistance <= 0)
+			return 0;
+
+		const int64_t distanceSquared = DistanceSquared(coord);
+		int64_t threshold = m_settings.lodDistance;
+		uint32_t lod = 0;
+		while (lod < ChunkMesh::MAX_LOD && distanceSquared > threshold * threshold) {
+			lod++;
+			threshold *= 2;
+		}
+
+		return lod;
+	}
+
+	void ChunkManager::RebuildLoadQueue() {
+		m_loadQueue.clear();
+
+		const int32_t r = m_settings.viewRadius;
+		const int32_t vr = m_settings.verticalRadius;
+		for (int32_t y = -vr; y <= vr; y++) {
+			for (int32_t z = -r; z <= r; z++) {
+				for (int32_t x = -r; x <= r; x++) {
+					vec3i coord(m_centerChunk.x + x, m_centerChunk.y + y, m_centerChunk.z + z);
+					if (!InRange(coord, 0))
+						continue;
+					if (m_loadedChunks.find(PackCoord(coord)) != m_loadedChunks.end())
+						continue;
+
+					m_loadQueue.push_back(coord);
+				}
+			}
+		}
+
+		// farthest first, so the nearest chunk is always at the back of the queue
+		std::sort(m_loadQueue.begin(), m_loadQueue.end(), [this](const vec3i& a, const vec3i& b) {
+			return DistanceSquared(a) > DistanceSquared(b);
+		});
+	}
+
+	void ChunkManager::EvictOutOfRange() {
+		std::vector<uint64_t> evicted;
+		for (auto& pair : m_loadedChunks) {
+			// one chunk of hysteresis stops chunks on the boundary from thrashing
+			if (!InRange(pair.second.coord, 1)) {
+				evicted.push_back(pair.first);
+			}
+		}
+
+		for (uint64_t key : evicted) {
+			UnloadChunk(key);
+		}
+
+		evicted.clear();
+		for (auto& pair : m_warmChunks) {
+			if (!InRange(UnpackCoord(pair.first), m_settings.keepAliveDistance)) {
+				evicted.push_back(pair.first);
+			}
+		}
+
+		for (uint64_t key : evicted) {
+			RemoveWarmChunk(key, true);
+		}
+
+		// cancel work for chunks that left the radius before their job finished
+		for (auto it = m_pendingJobs.begin(); it != m_pendingJobs.end();) {
+			if (!InRange(UnpackCoord(it->first), 1)) {
+				it->second->Cancel();
+				it = m_pendingJobs.erase(it);
+			}
+			else {
+				it++;
+			}
+		}
+	}
+
+	void ChunkManager::EnforceMemoryBudget() {
+		// chunks being demoted give their memory back on their own
+		while (m_memoryUsage - m_demotingMemoryUsage > m_settings.memoryBudget && !m_loadedChunks.empty()) {
+			auto farthest = m_loadedChunks.begin();
+			for (auto it = m_loadedChunks.begin(); it != m_loadedChunks.end(); it++) {
+				if (DistanceSquared(it->second.coord) > DistanceSquared(farthest->second.coord)) {
+					farthest = it;
+				}
+			}
+
+			UnloadChunk(farthest->first);
+		}
+	}
+
+	bool ChunkManager::ScheduleChunk(const vec3i& coord) {
+		// don't start a load that is guaranteed to push us over the budget
+		uint64_t estimate = m_loadedChunks.empty() ? 0 : (m_memoryUsage - m_demotingMemoryUsage) / m_loadedChunks.size();
+		if (m_memoryUsage + estimate * (m_pendingJobs.size() + 1) > m_settings.memoryBudget) {
+			m_loadQueue.push_back(coord);
+			return false;
+		}
+
+		std::shared_ptr<ChunkBuildResult> result = std::make_shared<ChunkBuildResult>();
+		result->borderMask = CaptureBorders(coord, result->borders);
+		result->lod = static_cast<uint8_t>(LodFor(coord));
+		const vec3f origin = ChunkToWorld(coord);
+		const uint64_t key = PackCoord(coord);
+		RegionStore* regions = m_regions;
+		const TerrainGenerator* generator = &m_generator;
+
+		// the warm entry is only dropped once the chunk is hot again, so nothing is lost if this job is cancelled
+		std::shared_ptr<const WarmChunk> warm;
+		auto warmIt = m_warmChunks.find(key);
+		if (warmIt != m_warmChunks.end()) {
+			warm = warmIt->second;
+			result->unsaved = warm->unsaved;
+		}
+
+		JobHandle job = m_jobs.Schedule(
+			[result, origin, coord, regions, generator, warm](const Job& job) {
+				// previously visited chunks come back from memory or disk instead of being regenerated
+				VoxelStorage stored;
+				if (warm != nullptr) {
+					static thread_local std::vector<uint8_t> values;
+					values.resize(warm->voxels.count());
+					warm->voxels.decode(values.data(), warm->voxels.count());
+					stored.Pack(values.data(), warm->voxels.count());
+					result->chunk = new Chunk(origin, stored);
+				}
+				else if (regions != nullptr && regions->LoadChunk(coord, stored)) {
+					result->chunk = new Chunk(origin, stored);
+					result->unsaved = false;
+				}
+				else {
+					result->chunk = new Chunk(origin, *generator);
+				}
+
+				if (job.IsCancelled())
+					return;
+
+				result->mesh = new ChunkMesh(*result->chunk, &result->borders, result->lod);
+			},
+			[this, result, coord]() {
+				OnChunkBuilt(coord, *result);
+			},
+			static_cast<float>(DistanceSquared(coord)),
+			key);
+
+		m_pendingJobs.emplace(key, job);
+		return true;
+	}
+
+	void ChunkManager::OnChunkBuilt(const vec3i& coord, ChunkBuildResult& result) {
+		const uint64_t key = PackCoord(coord);
+		m_pendingJobs.erase(key);
+
+		if (result.chunk == nullptr || result.mesh == nullptr || !InRange(coord, 1))
+			return;
+
+		ChunkEntry entry;
+		entry.coord = coord;
+		entry.chunk = result.chunk;
+		entry.mesh = result.mesh;
+		entry.memoryUsage = entry.chunk->getMemoryUsage() + entry.mesh->MemoryUsage();
+		entry.meshedNeighbours = result.borderMask;
+		entry.unsaved = result.unsaved;
+		entry.enclosed = false;
+		entry.mesh->Upload();
+
+		// the entry owns these now
+		result.chunk = nullptr;
+		result.mesh = nullptr;
+
+		m_memoryUsage += entry.memoryUsage;
+		m_loadedChunks.emplace(key, entry);
+
+		if (m_warmChunks.find(key) != m_warmChunks.end()) {
+			RemoveWarmChunk(key, false);
+		}
+
+		// this chunk and its neighbours can now cull the faces between them, or hide each other entirely
+		RefreshMeshes(coord);
+	}
+
+	void ChunkManager::UnloadChunk(uint64_t key) {
+		auto it = m_loadedChunks.find(key);
+		if (it == m_loadedChunks.end())
+			return;
+
+		auto remesh = m_pendingRemeshes.find(key);
+		if (remesh != m_pendingRemeshes.end()) {
+			remesh->second.job->Cancel();
+			m_pendingRemeshes.erase(remesh);
+		}
+
+		const vec3i coord = it->second.coord;
+		Chunk* chunk = it->second.chunk;
+		std::shared_ptr<WarmChunk> warm = std::make_shared<WarmChunk>();
+		warm->unsaved = it->second.unsaved;
+
+		// only the mesh goes now, the voxels are counted until the chunk is deleted
+		const uint64_t chunkMemory = chunk->getMemoryUsage();
+		m_memoryUsage = m_memoryUsage - it->second.memoryUsage + chunkMemory;
+		m_demotingMemoryUsage += chunkMemory;
+		delete it->second.mesh;
+		m_loadedChunks.erase(it);
+
+		// unpacking and encoding a chunk takes a few hundred microseconds, too long to do a ring of them in one frame.
+		// CollectDemotions() picks the result up, so there is no completion callback
+		JobHandle job = m_jobs.Schedule(
+			[chunk, warm](const Job&) {
+				static thread_local std::vector<uint8_t> values;
+				const VoxelStorage& voxels = chunk->getStorage();
+				values.resize(voxels.Size());
+				voxels.Unpack(values.data());
+				warm->voxels.encode(values.data(), voxels.Size());
+			},
+			nullptr,
+			0.0f,
+			key | DEMOTION_TAG);
+
+		m_pendingDemotions.emplace(key, PendingDemotion{ job, chunk, warm, chunkMemory });
+
+		// neighbours culled faces against this chunk, so they need those faces back
+		RefreshMeshes(coord);
+	}
+
+	void ChunkManager::CollectDemotions() {
+		std::vector<vec3i> finished;
+		for (auto& pair : m_pendingDemotions) {
+			if (pair.second.job->IsFinished()) {
+				finished.push_back(UnpackCoord(pair.first));
+			}
+		}
+
+		for (const vec3i& coord : finished) {
+			OnChunkDemoted(coord);
+		}
+	}
+
+	void ChunkManager::OnChunkDemoted(const vec3i& coord) {
+		const uint64_t key = PackCoord(coord);
+		auto it = m_pendingDemotions.find(key);
+		if (it == m_pendingDemotions.end())
+			return;
+
+		std::shared_ptr<WarmChunk> warm = it->second.warm;
+		delete it->second.chunk;
+		m_memoryUsage -= it->second.memoryUsage;
+		m_demotingMemoryUsage -= it->second.memoryUsage;
+		m_pendingDemotions.erase(it);
+
+		m_warmLru.push_front(key);
+		warm->lruPosition = m_warmLru.begin();
+		m_warmChunks.emplace(key, warm);
+		m_warmMemoryUsage += warm->voxels.memoryUsage();
+
+		if (!InRange(coord, m_settings.keepAliveDistance)) {
+			RemoveWarmChunk(key, true);
+			return;
+		}
+
+		// the camera may have come back while it was being compressed
+		if (InRange(coord, 0)) {
+			m_loadQueue.push_back(coord);
+		}
+
+		EnforceKeepAliveBudget();
+	}
+
+	void ChunkManager::RemoveWarmChunk(uint64_t key, const bool save) {
+		auto it = m_warmChunks.find(key);
+		if (it == m_warmChunks.end())
+			return;
+
+		const WarmChunk& warm = *it->second;
+		if (save && warm.unsaved && m_regions != nullptr) {
+			m_regions->SaveChunk(UnpackCoord(key), warm.voxels);
+		}
+
+		m_warmMemoryUsage -= warm.voxels.memoryUsage();
+		m_warmLru.erase(warm.lruPosition);
+		m_warmChunks.erase(it);
+	}
+
+	void ChunkManager::EnforceKeepAliveBudget() {
+		while (m_warmMemoryUsage > m_settings.keepAliveBudget && !m_warmLru.empty()) {
+			RemoveWarmChunk(m_warmLru.back(), true);
+		}
+	}
+
+	ChunkResidency ChunkManager::GetResidency(const vec3i& coord) const {
+		const uint64_t key = PackCoord(coord);
+		if (m_loadedChunks.find(key) != m_loadedChunks.end())
+			return ChunkResidency::hot;
+		if (m_warmChunks.find(key) != m_warmChunks.end() || m_pendingDemotions.find(key) != m_pendingDemotions.end())
+			return ChunkResidency::warm;
+
+		return ChunkResidency::cold;
+	}
+
+	void ChunkManager::SaveChunk(const ChunkEntry& entry) {
+		if (m_regions == nullptr || !entry.unsaved)
+			return;
+
+		m_regions->SaveChunk(entry.coord, entry.chunk->getStorage());
+	}
+
+	uint8_t ChunkManager::LoadedNeighbourMask(const vec3i& coord) const {
+		uint8_t mask = 0;
+		for (uint32_t dir = 0; dir < 6; dir++) {
+			if (m_loadedChunks.find(PackCoord(coord + NEIGHBOUR_OFFSETS[dir])) != m_loadedChunks.end()) {
+				mask |= 1 << dir;
+			}
+		}
+
+		return mask;
+	}
+
+	bool ChunkManager::IsEnclosed(const vec3i& coord) const {
+		for (uint32_t dir = 0; dir < 6; dir++) {
+			auto it = m_loadedChunks.find(PackCoord(coord + NEIGHBOUR_OFFSETS[dir]));
+			// the neighbour touches us with its opposite face
+			if (it == m_loadedChunks.end() || !it->second.chunk->getSummary().IsFaceSolid(static_cast<FaceDirection>(dir ^ 1)))
+				return false;
+		}
+
+		return true;
+	}
+
+	int32_t ChunkManager::OcclusionCell(const vec3i& coord) const {
+		// a box around the center covering everything InRange(coord, 1)
+		const int32_t radius = m_settings.viewRadius + 1;
+		const int32_t verticalRadius = m_settings.verticalRadius + 1;
+		const int32_t x = coord.x - m_centerChunk.x + radius;
+		const int32_t y = coord.y - m_centerChunk.y + verticalRadius;
+		const int32_t z = coord.z - m_centerChunk.z + radius;
+		const int32_t width = radius * 2 + 1;
+		if (x < 0 || x >= width || z < 0 || z >= width || y < 0 || y > verticalRadius * 2)
+			return -1;
+
+		return x + (z + y * width) * width;
+	}
+
+	void ChunkManager::FloodVisibleChunks(const Frustum* frustum) {
+		const int32_t width = (m_settings.viewRadius + 1) * 2 + 1;
+		const int32_t height = (m_settings.verticalRadius + 1) * 2 + 1;
+		m_occlusionVisited.assign(width * width * height, 0);
+		m_occlusionQueue.clear();
+
+		const vec3f chunkExtent(Chunk::CHUNK_SIZE_X, Chunk::CHUNK_SIZE_Y, Chunk::CHUNK_SIZE_Z);
+		m_occlusionVisited[OcclusionCell(m_centerChunk)] = 1;
+		m_occlusionQueue.push_back(OcclusionStep{ m_centerChunk, -1, 0 });
+
+		// breadth-first out of the camera's chunk. a chunk is only left through faces its air connects to the face
+		// it was entered by, and never back towards the camera, so anything reached has a line of sight through
+		// open faces. each chunk is entered once, by whichever path gets there first.
+		for (size_t head = 0; head < m_occlusionQueue.size(); head++) {
+			const OcclusionStep step = m_occlusionQueue[head];
+			auto it = m_loadedChunks.find(PackCoord(step.coord));
+			// chunks that aren't loaded yet can't hide anything
+			const ChunkSummary* summary = nullptr;
+			if (it != m_loadedChunks.end()) {
+				// edits since the last frame only marked the connections stale
+				it->second.chunk->refreshConnections();
+				summary = &it->second.chunk->getSummary();
+			}
+
+			for (uint32_t dir = 0; dir < 6; dir++) {
+				if (step.travelled & (1 << (dir ^ 1)))
+					continue;
+				if (summary != nullptr && step.entryFace >= 0 && !summary->CanSeeThrough(static_cast<FaceDirection>(step.entryFace), static_cast<FaceDirection>(dir)))
+					continue;
+
+				const vec3i next = step.coord + NEIGHBOUR_OFFSETS[dir];
+				const int32_t cell = OcclusionCell(next);
+				if (cell < 0 || m_occlusionVisited[cell] || !InRange(next, 1))
+					continue;
+
+				const vec3f origin = ChunkToWorld(next);
+				if (frustum != nullptr && !frustum->TestAABB(origin, origin + chunkExtent))
+					continue;
+
+				m_occlusionVisited[cell] = 1;
+				// we arrive through the neighbour's opposite face
+				m_occlusionQueue.push_back(OcclusionStep{ next, static_cast<int8_t>(dir ^ 1), static_cast<uint8_t>(step.travelled | (1 << dir)) });
+			}
+		}
+	}
+
+	uint8_t ChunkManager::CaptureBorders(const vec3i& coord, ChunkBorders& outBorders) const {
+		uint8_t mask = 0;
+		for (uint32_t dir = 0; dir < 6; dir++) {
+			auto it = m_loadedChunks.find(PackCoord(coord + NEIGHBOUR_OFFSETS[dir]));
+			if (it == m_loadedChunks.end())
+				continue;
+
+			ChunkMesh::ExtractBorder(it->second.chunk->getStorage(), static_cast<FaceDirection>(dir), outBorders.solid[dir]);
+			mask |= 1 << dir;
+		}
+
+		return mask;
+	}
+
+	void ChunkManager::RefreshMeshes(const vec3i& coord) {
+		for (int32_t i = -1; i < 6; i++) {
+			const vec3i target = i < 0 ? coord : coord + NEIGHBOUR_OFFSETS[i];
+			const uint64_t key = PackCoord(target);
+
+			auto it = m_loadedChunks.find(key);
+			if (it == m_loadedChunks.end())
+				continue;
+
+			it->second.enclosed = IsEnclosed(target);
+
+			// compare against what the mesh, or the remesh already in flight, was built with
+			auto pending = m_pendingRemeshes.find(key);
+			const uint8_t meshedMask = pending != m_pendingRemeshes.end() ? pending->second.borderMask : it->second.meshedNeighbours;
+			if (LoadedNeighbourMask(target) != meshedMask) {
+				ScheduleRemesh(target);
+			}
+		}
+	}
+
+	void ChunkManager::RefreshLods() {
+		for (const auto& pair : m_loadedChunks) {
+			// compare against the remesh already in flight, if any
+			auto pending = m_pendingRemeshes.find(pair.first);
+			const uint32_t lod = pending != m_pendingRemeshes.end() ? pending->second.lod : pair.second.mesh->Lod();
+			if (lod != LodFor(pair.second.coord)) {
+				ScheduleRemesh(pair.second.coord);
+			}
+		}
+	}
+
+	void ChunkManager::ScheduleRemesh(const vec3i& coord) {
+		const uint64_t key = PackCoord(coord);
+		auto it = m_loadedChunks.find(key);
+		if (it == m_loadedChunks.end())
+			return;
+
+		auto pending = m_pendingRemeshes.find(key);
+		if (pending != m_pendingRemeshes.end()) {
+			pending->second.job->Cancel();
+			m_pendingRemeshes.erase(pending);
+		}
+
+		// the chunk may be evicted or edited while the job runs, so mesh a copy of its voxels
+		std::shared_ptr<const VoxelStorage> snapshot = std::make_shared<VoxelStorage>(it->second.chunk->getStorage());
+		const ChunkSummary summary = it->second.chunk->getSummary();
+		std::shared_ptr<ChunkBuildResult> result = std::make_shared<ChunkBuildResult>();
+		result->borderMask = CaptureBorders(coord, result->borders);
+		result->lod = static_cast<uint8_t>(LodFor(coord));
+
+		JobHandle job = m_jobs.Schedule(
+			[result, snapshot, summary](const Job&) {
+				result->mesh = new ChunkMesh(*snapshot, &result->borders, &summary, result->lod);
+			},
+			[this, result, coord]() {
+				OnChunkRemeshed(coord, *result);
+			},
+			static_cast<float>(DistanceSquared(coord)),
+			key);
+
+		m_pendingRemeshes.emplace(key, PendingRemesh{ job, result->borderMask, result->lod });
+	}
+
+	void ChunkManager::OnChunkRemeshed(const vec3i& coord, ChunkBuildResult& result) {
+		const uint64_t key = PackCoord(coord);
+		m_pendingRemeshes.erase(key);
+
+		auto it = m_loadedChunks.find(key);
+		if (it == m_loadedChunks.end() || result.mesh == nullptr)
+			return;
+
+		ChunkEntry& entry = it->second;
+		m_memoryUsage -= entry.memoryUsage;
+
+		delete entry.mesh;
+		entry.mesh = result.mesh;
+		result.mesh = nullptr;
+		entry.mesh->Upload();
+
+		entry.meshedNeighbours = result.borderMask;
+		entry.memoryUsage = entry.chunk->getMemoryUsage() + entry.mesh->MemoryUsage();
+		m_memoryUsage += entry.memoryUsage;
+	}
+}
\ No newline at end of file